@@ -12,9 +12,15 @@
 #include "HVAC.h"
 #include <TimeLib.h>
 #include "eeMem.h"
+#include "OutCurve.h"
 
 extern void WsSend(char *txt, const char *type);
 
+#define COOL_LO 650 // target temperature limits *10
+#define COOL_HI 950
+#define HEAT_LO 630
+#define HEAT_HI 860
+
 HVAC::HVAC()
 {
   pinMode(P_FAN, OUTPUT);
@@ -463,16 +469,20 @@ void HVAC::calcTargetTemp(int mode)
   }
   int16_t L = m_outMin * 10;
   int16_t H = m_outMax * 10;
+  int16_t outTemp = m_outTemp;
+
+  if(outCurve.valid()) // current point on the forecast curve, summer curve is delayed 3 hours
+    outTemp = outCurve.get(now() - ((ee.tz+m_DST)*3600), mode != Mode_Heat);
 
   switch(mode)
   {
     case Mode_Off:
     case Mode_Cool:
-      m_targetTemp  = (m_outTemp-L) * (ee.coolTemp[1]-ee.coolTemp[0]) / (H-L) + ee.coolTemp[0];
+      m_targetTemp  = (outTemp-L) * (ee.coolTemp[1]-ee.coolTemp[0]) / (H-L) + ee.coolTemp[0];
       m_targetTemp = constrain(m_targetTemp, ee.coolTemp[0], ee.coolTemp[1]); // just for safety
       break;
     case Mode_Heat:
-      m_targetTemp  = (m_outTemp-L) * (ee.heatTemp[1]-ee.heatTemp[0]) / (H-L) + ee.heatTemp[0];
+      m_targetTemp  = (outTemp-L) * (ee.heatTemp[1]-ee.heatTemp[0]) / (H-L) + ee.heatTemp[0];
       m_targetTemp = constrain(m_targetTemp, ee.heatTemp[0], ee.heatTemp[1]); // just for safety
       break;
   }
@@ -603,11 +613,12 @@ void HVAC::setTemp(int mode, int16_t Temp, int hl)
   switch(mode)
   {
     case Mode_Off:        // keep a value at least
-      calcTargetTemp(ee.Mode);
+      if(!m_bBatch)
+        calcTargetTemp(ee.Mode);
       break;
  
     case Mode_Cool:
-      if(Temp < 650 || Temp > 950)    // ensure sane values
+      if(Temp < COOL_LO || Temp > COOL_HI)    // ensure sane values
         break;
       ee.coolTemp[hl] = Temp;
       if(hl)
@@ -622,12 +633,12 @@ void HVAC::setTemp(int mode, int16_t Temp, int hl)
       ee.heatTemp[1] = min(ee.coolTemp[0] - 20, ee.heatTemp[1]); // Keep 2.0 degree differential for Auto mode
       ee.heatTemp[0] = ee.heatTemp[1] - save;                      // shift heat low by original diff
 
-      if(ee.Mode == Mode_Cool)
+      if(ee.Mode == Mode_Cool && !m_bBatch)
         calcTargetTemp(ee.Mode);
 
       break;
     case Mode_Heat:
-      if(Temp < 630 || Temp > 860)    // ensure sane values
+      if(Temp < HEAT_LO || Temp > HEAT_HI)    // ensure sane values
         break;
       ee.heatTemp[hl] = Temp;
       if(hl)
@@ -642,7 +653,7 @@ void HVAC::setTemp(int mode, int16_t Temp, int hl)
       ee.coolTemp[0] = max(ee.heatTemp[1] - 20, ee.coolTemp[0]);
       ee.coolTemp[1] = ee.coolTemp[0] + save;
 
-      if(ee.Mode == Mode_Heat)
+      if(ee.Mode == Mode_Heat && !m_bBatch)
         calcTargetTemp(ee.Mode);
 
       break;
@@ -702,6 +713,7 @@ void HVAC::updateIndoorTemp(int16_t Temp, int16_t rh)
       if(m_rh < ee.rhLevel[0]) // heating and cooling both reduce humidity
       {
         if(ee.humidMode == HM_Auto1 && m_bRunning == false); // do nothing
+        else if(outdoorMoist()); // outside air brings the humidity back up
         else
         {
           humidSwitch(true);
@@ -723,6 +735,25 @@ void HVAC::updateOutdoorTemp(int16_t outTemp)
   m_outTemp = outTemp;
 }
 
+// Update outdoor dew point from the forecast
+void HVAC::updateOutdoorDew(int16_t dew)
+{
+  m_outDew = dew;
+}
+
+// true if the forecast dew point is at or over the indoor dew point
+bool HVAC::outdoorMoist()
+{
+  if(m_outDew == DEW_NONE || m_rh <= 0)
+    return false;
+
+  // Magnus formula in C
+  float t = (m_inTemp - 320) / 18.0;
+  float g = log(m_rh / 1000.0) + 17.62 * t / (243.12 + t);
+  int16_t dew = (243.12 * g / (17.62 - g)) * 18 + 320; // back to F *10
+  return (m_outDew >= dew);
+}
+
 void HVAC::resetFilter()
 {
   m_filterMinutes = 0;
@@ -887,24 +918,86 @@ const char *cmdList[] = { "cmd",
   NULL
 };
 
-int HVAC::CmdIdx(String s )
+int HVAC::CmdIdx(const char *p)
 {
   int iCmd;
   // skip the top 4 (event, key, data)
   for(iCmd = 4; cmdList[iCmd]; iCmd++)
   {
-    if( s.equalsIgnoreCase( String(cmdList[iCmd]) ) )
+    if( !strcasecmp(p, cmdList[iCmd]) )
       break;
   }
   return iCmd - 4;
 }
 
 // POST set params as "fanmode=1"
-void HVAC::setVar(String sCmd, int val)
+void HVAC::setVar(const char *pCmd, int val)
+{
+  setVar(CmdIdx(pCmd), val);
+}
+
+// Limits of each setting by setVar index.  setVar clamps to them (setTemp ignores an out of range
+// temperature), and setVars refuses the whole batch if any value is outside them
+#define VL_ANY INT32_MIN, INT32_MAX // value not used
+static const struct
 {
-  if(ee.bLock) return;
+  int32_t lo;
+  int32_t hi;
+} varLimit[] =
+{
+  {FM_Auto, 3},        // fanmode, 3 = freshen
+  {Mode_Off, Mode_Auto}, // mode
+  {Heat_HP, Heat_Auto}, // heatmode
+  {VL_ANY},            // resettotal
+  {VL_ANY},            // resetfilter
+  {0, 60*5},           // fanpostdelay 0 to 5 minutes
+  {60, 60*20},         // cyclemin 1 to 20 minutes
+  {60*2, 60*60},       // cyclemax 2 to 60 minutes
+  {60, 60*30},         // idlemin 1 to 30 minutes
+  {5, 50},             // cyclethresh 0.5 to 5.0 degrees
+  {COOL_LO, COOL_HI},  // cooltempl
+  {COOL_LO, COOL_HI},  // cooltemph
+  {HEAT_LO, HEAT_HI},  // heattempl
+  {HEAT_LO, HEAT_HI},  // heattemph
+  {5, 50},             // eheatthresh 5 to 50 degrees F
+  {-99, 99},           // override +/-9.9 degrees F, 0 = cancel
+  {60*1, 60*60*6},     // overridetime 1 min to 6 hours
+  {HM_Off, HM_Auto2},  // humidmode
+  {300, 900},          // humidl (no idea really)
+  {300, 900},          // humidh
+  {-30, 30},           // adj, calibrate can only be +/-3.0
+  {0, 60*8},           // fanpretime 0 to 8 minutes
+  {0, 0xFFFF},         // fancycletime
+  {0, 0xF},            // rmtflgs
+  {0, 0xFFFF},         // awaytime (minutes)
+  {-150, 150},         // awaydelta, -15 for heat and +15 for cool
+  {0, 1},              // away
+  {0, 0xFFFF},         // ppk
+  {0, 0xFFFF},         // ccf
+  {0, 0xFFFF},         // cfm
+  {0, INT32_MAX},      // ce
+  {0, INT32_MAX},      // cg
+  {1, 46},             // fcrange
+  {1, 46},             // fcdisp
+  {VL_ANY},            // save
+  {-12, 12},           // tz
+  {0, 0xFFFF},         // cw
+  {0, 0xFFFF},         // fw
+  {0, 0xFFFF},         // frnw
+  {0, 0xFFFF},         // hfw
+  {0, 0xFFFF},         // ffp
+};
+#define VAR_CNT (int)(sizeof(varLimit) / sizeof(varLimit[0]))
+
+// cmdList index - 4, as JsonParse gives it
+void HVAC::setVar(int iCmd, int val)
+{
+  if(ee.bLock || iCmd < 0 || iCmd >= VAR_CNT) return;
 
-  switch( CmdIdx( sCmd ) )
+  if(iCmd < 10 || iCmd > 13) // not the temperatures
+    val = constrain(val, varLimit[iCmd].lo, varLimit[iCmd].hi);
+
+  switch( iCmd )
   {
     case 0:     // fanmode
       if(val == 3) // "freshen"
@@ -929,19 +1022,19 @@ void HVAC::setVar(String sCmd, int val)
       resetFilter();
       break;
     case 5:     // fanpostdelay
-      ee.fanPostDelay[digitalRead(P_REV)] = constrain(val, 0, 60*5); // Limit 0 to 5 minutes
+      ee.fanPostDelay[digitalRead(P_REV)] = val;
       break;
     case 6:     // cyclemin
-      ee.cycleMin = constrain(val, 60, 60*20); // Limit 1 to 20 minutes
+      ee.cycleMin = val;
       break;
     case 7:     // cyclemax
-      ee.cycleMax = constrain(val, 60*2, 60*60); // Limit 2 to 60 minutes
+      ee.cycleMax = val;
       break;
     case 8:     // idlemin
-      ee.idleMin = constrain(val, 60, 60*30); // Limit 1 to 30 minutes
+      ee.idleMin = val;
       break;
     case 9:    // cyclethresh
-      ee.cycleThresh[ee.Mode == Mode_Heat] = constrain(val, 5, 50); // Limit 0.5 to 5.0 degrees
+      ee.cycleThresh[ee.Mode == Mode_Heat] = val;
       break;
     case 10:    // cooltempl
       setTemp(Mode_Cool, val, 0);
@@ -960,7 +1053,7 @@ void HVAC::setVar(String sCmd, int val)
       m_bRecheck = true;
       break;
     case 14:    // eheatthresh
-      ee.eHeatThresh = constrain(val, 5, 50); // Limit 5 to 50 degrees F
+      ee.eHeatThresh = val;
       break;
     case 15:    // override
       if(val == 0)    // cancel
@@ -970,28 +1063,28 @@ void HVAC::setVar(String sCmd, int val)
       }
       else
       {
-        m_ovrTemp = constrain(val, -99, 99); // Limit to +/-9.9 degrees F
+        m_ovrTemp = val;
         m_overrideTimer = ee.overrideTime;
       }
       m_bRecheck = true;
       break;
     case 16:    // overridetime
-      ee.overrideTime = constrain(val, 60*1, 60*60*6); // Limit 1 min to 6 hours
+      ee.overrideTime = val;
       break;
     case 17: // humidmode
-      ee.humidMode = constrain(val, HM_Off, HM_Auto2);
+      ee.humidMode = val;
       break;
     case 18: // humidl
-      ee.rhLevel[0] = constrain(val, 300, 900); // no idea really
+      ee.rhLevel[0] = val;
       break;
     case 19: // humidh
-      ee.rhLevel[1] = constrain(val, 300, 900);
+      ee.rhLevel[1] = val;
       break;
     case 20: // adj
-      ee.adj = constrain(val, -30, 30); // calibrate can only be +/-3.0
+      ee.adj = val;
       break;
     case 21:     // fanPretime
-      ee.fanPreTime[ee.Mode == Mode_Heat] = constrain(val, 0, 60*8); // Limit 0 to 8 minutes
+      ee.fanPreTime[ee.Mode == Mode_Heat] = val;
       break;
     case 22: // fancycletime
       ee.fanCycleTime = val;
@@ -1002,7 +1095,7 @@ void HVAC::setVar(String sCmd, int val)
       m_RemoteFlags = val;
       break;
     case 24: // awaytime
-      ee.awayTime = val; // no limit
+      ee.awayTime = val;
       break;
     case 25: // awaydelta
       if(ee.Mode == Mode_Heat)
@@ -1040,16 +1133,16 @@ void HVAC::setVar(String sCmd, int val)
       m_fCostG = val / 10000;
       break;
     case 32: // fcrange
-      ee.fcRange = constrain(val, 1, 46);
+      ee.fcRange = val;
       break;
     case 33: // fcdisp
-      ee.fcDisplay = constrain(val, 1, 46);
+      ee.fcDisplay = val;
       break;
     case 34: // force save
       eemem.update();
       break;
     case 35: // TZ
-      ee.tz = constrain(val, -12, 12);
+      ee.tz = val;
       break;
     case 36:
       ee.compressorWatts = val;
@@ -1069,6 +1162,40 @@ void HVAC::setVar(String sCmd, int val)
   }
 }
 
+// Several settings at once, as from a profile.  All are checked first and none are
+// applied if any is bad.  The target is calculated once, and EEPROM written at most once (with "save")
+bool HVAC::setVars(const uint8_t *pCmd, const int *pVal, uint8_t cnt)
+{
+  if(ee.bLock) return false;
+
+  int nCmds = CmdIdx(""); // no match = number of settings
+  int iSave = CmdIdx("save");
+  bool bSave = false;
+
+  for(uint8_t i = 0; i < cnt; i++)
+  {
+    int iCmd = pCmd[i];
+    if(iCmd >= nCmds || iCmd >= VAR_CNT)
+      return false;
+    if(pVal[i] < varLimit[iCmd].lo || pVal[i] > varLimit[iCmd].hi) // the limits setVar clamps to
+      return false;
+    if(iCmd == iSave)
+      bSave = true;
+  }
+
+  m_bBatch = true;
+  for(uint8_t i = 0; i < cnt; i++)
+    if(pCmd[i] != iSave)
+      setVar(pCmd[i], pVal[i]);
+  m_bBatch = false;
+
+  calcTargetTemp(ee.Mode);
+  m_bRecheck = true;
+  if(bSave)
+    eemem.update();
+  return true;
+}
+
 void HVAC::dayTotals(int d)
 {
   ee.fCostDay[d][0] = m_fCostE;
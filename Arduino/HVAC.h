@@ -70,6 +70,8 @@ enum HumidifierMode
 #define RF_RL (1 << 2)
 #define RF_RH (1 << 3)
 
+#define DEW_NONE -32768 // no outdoor dew point from the forecast
+
 class HVAC
 {
 public:
@@ -97,11 +99,15 @@ public:
   bool    isRemote(void);          // just indicate remote unit or not
   void    updateIndoorTemp(int16_t Temp, int16_t rh);
   void    updateOutdoorTemp(int16_t outTemp);
+  void    updateOutdoorDew(int16_t dew); // forecast dew point *10, DEW_NONE if none
+  bool    outdoorMoist(void);   // outdoor dew point at or above indoor
   void    resetFilter(void);    // reset the filter hour count
   bool    checkFilter(void);
   void    resetTotal(void);
   bool    tempChange(void);
-  void    setVar(String sCmd, int val); // remote settings
+  void    setVar(const char *pCmd, int val); // remote settings
+  void    setVar(int iCmd, int val);    // by index, 0 = "fanmode"
+  bool    setVars(const uint8_t *pCmd, const int *pVal, uint8_t cnt); // all or nothing
   void    updateVar(int iName, int iValue); // host values
   void    setSettings(int iName, int iValue);// remote settings
   void    enable(void);
@@ -112,6 +118,7 @@ public:
   void    monthTotal(int m);
 
   int16_t  m_outTemp;       // adjusted current temp *10
+  int16_t  m_outDew = DEW_NONE; // forecast dew point *10
   int16_t  m_inTemp;        // current indoor temperature *10
   int16_t  m_rh;
   int16_t  m_localTemp;     // this device's temperature *10
@@ -135,7 +142,7 @@ private:
   bool  preCalcCycle(int mode);
   void  calcTargetTemp(int mode);
   void  costAdd(int secs, int mode, int hm);
-  int   CmdIdx(String s);
+  int   CmdIdx(const char *p);
   void  sendCmd(const char *szName, int value);
 
   int8_t  m_FanMode;        // Auto=0, On=1, s=2
@@ -149,6 +156,7 @@ private:
   bool    m_bStart;         // signal to start
   bool    m_bStop;          // signal to stop
   bool    m_bRecheck;       // recalculate target now
+  bool    m_bBatch;         // setVars() is applying, calcTargetTemp once at the end
   bool    m_bEnabled;       // enables system
   bool    m_bAway;
   uint8_t  m_RemoteFlags = RF_RL|RF_RH;
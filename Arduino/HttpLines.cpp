@@ -0,0 +1,181 @@
+#include "HttpLines.h"
+
+enum HL_State
+{
+  HL_Status,    // first line
+  HL_Header,
+  HL_Body,
+  HL_ChunkSize,
+  HL_ChunkData,
+  HL_ChunkEnd,  // CRLF after the data
+  HL_Done,      // last chunk read
+};
+
+HttpLines::HttpLines(void (*line_callback)(char *pLine, bool bHeader))
+{
+  m_callback = line_callback;
+  m_etag[0] = 0;
+  m_modified[0] = 0;
+  begin();
+}
+
+void HttpLines::begin()
+{
+  m_state = HL_Status;
+  m_status = 0;
+  m_bComplete = false;
+  m_bChunked = false;
+  m_length = -1;
+  m_bodyLen = 0;
+  m_len = 0;
+  m_ctlLen = 0;
+}
+
+void HttpLines::data(const char *data, size_t len)
+{
+  const char *pEnd = data + len;
+
+  while(data < pEnd)
+  {
+    char c = *data++;
+
+    switch(m_state)
+    {
+      case HL_ChunkSize:
+      case HL_ChunkEnd:
+        if(c == '\n')
+          ctlDone();
+        else if(c != '\r' && m_ctlLen < sizeof(m_ctl) - 1)
+          m_ctl[m_ctlLen++] = c;
+        break;
+      case HL_Done:
+        return;
+      case HL_Body:
+        m_bodyLen++;
+        if(c == '\n')
+          lineDone();
+        else if(c != '\r' && m_len < HL_LINE)
+          m_line[m_len++] = c;
+        break;
+      case HL_ChunkData:
+        if(--m_chunk == 0)
+        {
+          m_state = HL_ChunkEnd;
+          m_ctlLen = 0;
+        }
+        // fall through
+      default:
+        if(c == '\n')
+          lineDone();
+        else if(c != '\r' && m_len < HL_LINE)
+          m_line[m_len++] = c;
+        break;
+    }
+  }
+}
+
+void HttpLines::end()
+{
+  if(m_len && m_state != HL_Status && m_state != HL_Header)
+    lineDone();
+
+  if(m_state == HL_Status || m_state == HL_Header) // cut off in the headers
+    m_bComplete = false;
+  else
+    m_bComplete = m_bChunked ? (m_state == HL_Done) : (m_length < 0 || m_bodyLen == (uint32_t)m_length);
+  if(m_status != 304 && (m_status != 200 || !m_bComplete)) // only ask again for what was fully read
+  {
+    m_etag[0] = 0;
+    m_modified[0] = 0;
+  }
+}
+
+void HttpLines::validators(String &s)
+{
+  if(m_etag[0])
+  {
+    s += "If-None-Match: ";
+    s += m_etag;
+    s += "\n";
+  }
+  if(m_modified[0])
+  {
+    s += "If-Modified-Since: ";
+    s += m_modified;
+    s += "\n";
+  }
+}
+
+// a complete line of headers or body
+void HttpLines::lineDone()
+{
+  m_line[m_len] = 0;
+  m_len = 0;
+
+  switch(m_state)
+  {
+    case HL_Status:
+      if(strncmp(m_line, "HTTP/", 5)) // no headers, it's all body
+      {
+        m_state = HL_Body;
+        m_callback(m_line, false);
+        return;
+      }
+      m_status = atoi(strchr(m_line, ' ') ? strchr(m_line, ' ') + 1 : m_line);
+      m_state = HL_Header;
+      if(m_status == 200)  // new validators only from this response
+      {
+        m_etag[0] = 0;
+        m_modified[0] = 0;
+      }
+      m_callback(m_line, true);
+      break;
+    case HL_Header:
+      if(m_line[0] == 0) // blank line ends the headers
+      {
+        m_state = m_bChunked ? HL_ChunkSize : HL_Body;
+        m_ctlLen = 0;
+        break;
+      }
+      if(!strncasecmp(m_line, "Transfer-Encoding:", 18) && strstr(m_line + 18, "chunked"))
+        m_bChunked = true;
+      else if(!strncasecmp(m_line, "Content-Length:", 15))
+        m_length = atol(m_line + 15);
+      else if(m_status == 200 && !strncasecmp(m_line, "ETag: ", 6))
+      {
+        strncpy(m_etag, m_line + 6, sizeof(m_etag) - 1);
+        m_etag[sizeof(m_etag) - 1] = 0;
+      }
+      else if(m_status == 200 && !strncasecmp(m_line, "Last-Modified: ", 15))
+      {
+        strncpy(m_modified, m_line + 15, sizeof(m_modified) - 1);
+        m_modified[sizeof(m_modified) - 1] = 0;
+      }
+      m_callback(m_line, true);
+      break;
+    default:
+      m_callback(m_line, false);
+      break;
+  }
+}
+
+// chunk size, or the CRLF after chunk data
+void HttpLines::ctlDone()
+{
+  m_ctl[m_ctlLen] = 0;
+  m_ctlLen = 0;
+
+  if(m_state == HL_ChunkEnd)
+  {
+    m_state = HL_ChunkSize;
+    return;
+  }
+  m_chunk = strtoul(m_ctl, NULL, 16); // ignores any ;extension
+  if(m_chunk)
+    m_state = HL_ChunkData;
+  else
+  {
+    m_state = HL_Done; // last chunk, trailers are ignored
+    end();
+  }
+}
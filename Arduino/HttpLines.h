@@ -0,0 +1,39 @@
+#ifndef HTTPLINES_H
+#define HTTPLINES_H
+
+#include <Arduino.h>
+
+#define HL_LINE 100 // longest line kept, the rest is cut
+
+// Incremental HTTP response reader.  Splits the headers and the (optionally chunked) body into
+// lines, carrying a partial line between TCP segments
+class HttpLines
+{
+public:
+  HttpLines(void (*line_callback)(char *pLine, bool bHeader));
+  void begin(void);                    // on connect
+  void data(const char *data, size_t len);
+  void end(void);                      // on disconnect, sends any last line without a newline
+  void validators(String &s);          // add If-None-Match/If-Modified-Since lines to a request
+  int  m_status;                       // HTTP status, 0 = none yet
+  bool m_bComplete;                    // set by end(), the whole body came (last chunk or Content-Length)
+  char m_etag[48];                     // validators of the last complete response
+  char m_modified[32];
+
+private:
+  void lineDone(void);
+  void ctlDone(void);
+
+  void (*m_callback)(char *pLine, bool bHeader);
+  char     m_line[HL_LINE + 1];
+  char     m_ctl[16];   // chunk size line
+  uint8_t  m_len;
+  uint8_t  m_ctlLen;
+  uint8_t  m_state;
+  bool     m_bChunked;
+  uint32_t m_chunk;     // bytes left in the current chunk
+  int32_t  m_length;    // Content-Length, -1 = until disconnect
+  uint32_t m_bodyLen;
+};
+
+#endif // HTTPLINES_H
@@ -1,82 +1,163 @@
 #include "Nextion.h"
 
-// get changes
+#define NEX_RXSTR 255 // data ends at the first 0xFF
+
+// get changes, never waits.  Events are [code][data][FF FF FF]
 int Nextion::service(char *pBuf)
 {
   dimmer();
-  if(!Serial.available())
-    return 0;
-  int len = Serial.readBytesUntil(0xFF, pBuf, 63);
+  drain(false);
 
-  if(len < 3) // could be the other 2 FFs
-    return 0;
-  pBuf[len] = 0; // change FF to NULL
-  return len;
+  while(Serial.available())
+  {
+    if(!rxByte(Serial.read()))
+      continue;
+    uint8_t len = m_rxLen;
+    memcpy(pBuf, m_rx, len);
+    pBuf[len] = 0; // strings are NULL terminated
+    m_rxLen = 0;
+    if(pBuf[0] == 0x66 && (uint8_t)pBuf[1] != m_page) // current page id (sendme)
+    {
+      m_page = pBuf[1];
+      invalidate();
+    }
+    else if((uint8_t)pBuf[0] < 0x65) // error codes
+      m_rxErrors++;
+    return len;
+  }
+  return 0;
 }
 
-void Nextion::itemText(uint8_t id, String t)
+// add a byte to the current event, true when the event is complete
+bool Nextion::rxByte(uint8_t c)
 {
-  Serial.print(String("t") + id + ".txt=\"" + t + "\"");
-  FFF();
+  if(m_rxLen == 0) // event code
+  {
+    if(c == 0xFF) // leftover terminator
+      return false;
+    switch(c)
+    {
+      case 0x65: m_rxNeed = 3; break; // touch: page, id, event
+      case 0x66: m_rxNeed = 1; break; // page id
+      case 0x67: // touch coordinates: x, y, event
+      case 0x68: m_rxNeed = 5; break;
+      case 0x70: m_rxNeed = NEX_RXSTR; break; // string
+      case 0x71: m_rxNeed = 4; break; // 32 bit number
+      default:   m_rxNeed = 0; break; // error and status codes
+    }
+    m_rx[m_rxLen++] = c;
+    m_rxFF = 0;
+    return false;
+  }
+
+  if(m_rxFF == 0 && (m_rxNeed == NEX_RXSTR ? (c != 0xFF) : (m_rxLen <= m_rxNeed)) ) // data (fixed data can hold 0xFF)
+  {
+    if(m_rxLen < NEX_RX - 1)
+      m_rx[m_rxLen++] = c;
+    return false;
+  }
+
+  if(c == 0xFF)
+    return (++m_rxFF == 3);
+
+  m_rxErrors++; // bad terminator, drop it and start over with this byte
+  m_rxLen = 0;
+  return rxByte(c);
 }
 
-void Nextion::btnText(uint8_t id, String t)
+bool Nextion::itemText(uint8_t id, const char *t)
 {
-  Serial.print(String("b") + id + ".txt=\"" + t + "\"");
-  FFF();
+  return setProp('t', id, NP_TXT, t);
 }
 
-void Nextion::itemFp(uint8_t id, uint16_t val) // 123 to 12.3
+bool Nextion::btnText(uint8_t id, const char *t)
 {
-  Serial.print(String("f") + id + ".txt=\"" + (val / 10) + "." + (val % 10) + "\"" );
-  FFF();
+  return setProp('b', id, NP_TXT, t);
 }
 
-void Nextion::itemNum(uint8_t item, int16_t num)
+bool Nextion::itemFp(uint8_t id, uint16_t val) // 123 to 12.3
 {
-  Serial.print(String("n") + item + ".val=" + num);
-  FFF();
+  return setProp('f', id, NP_FP, val);
+}
+
+bool Nextion::itemNum(uint8_t item, int16_t num)
+{
+  return setProp('n', item, NP_VAL, num);
 }
 
-void Nextion::refreshItem(String id)
+void Nextion::refreshItem(const char *id)
 {
-  Serial.print(String("ref ") + id);
+  emitProps();
+  put("ref ");
+  put(id);
   FFF();
 }
 
-void Nextion::text(uint16_t x, uint16_t y, uint16_t xCenter, uint16_t color, String sText)
+void Nextion::text(uint16_t x, uint16_t y, uint16_t xCenter, uint16_t color, const char *pText)
 {
   const uint16_t bkColor = m_page; // transparent source
   const uint8_t h = 16; // 8x16 for small font + space
-  uint16_t w = sText.length() * 9;
+  uint16_t w = strlen(pText) * 9;
 
-  Serial.print(String("xstr ") + x + "," + y + "," + w + ",16,1," + color + "," + bkColor +
-        "," + xCenter + ",1,0,\"" + sText + "\"");
+  emitProps();
+  put("xstr ");
+  putNum(x); put(',');
+  putNum(y); put(',');
+  putNum(w); put(',');
+  putNum(h); put(",1,");
+  putNum(color); put(',');
+  putNum(bkColor); put(',');
+  putNum(xCenter); put(",1,0,\"");
+  put(pText);
+  put('"');
   FFF();
 }
 
 void Nextion::fill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
 {
-  Serial.print(String("fill ") + x + "," + y + "," + w + "," + h + "," + color);
+  emitProps();
+  put("fill ");
+  putNum(x); put(',');
+  putNum(y); put(',');
+  putNum(w); put(',');
+  putNum(h); put(',');
+  putNum(color);
   FFF();
 }
 
 void Nextion::line(uint16_t x, uint16_t y, uint16_t x2, uint16_t y2, uint16_t color)
 {
-  Serial.print(String("line ") + x + "," + y + "," + x2 + "," + y2 + "," + color);
+  emitProps();
+  put("line ");
+  putNum(x); put(',');
+  putNum(y); put(',');
+  putNum(x2); put(',');
+  putNum(y2); put(',');
+  putNum(color);
   FFF();
 }
 
-void Nextion::visible(String id, uint8_t on)
+// restore an area from a full screen picture
+void Nextion::crop(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t pic)
 {
-  Serial.print(String("vis ") + id + "," + on);
+  emitProps();
+  put("crop ");
+  putNum(x); put(',');
+  putNum(y); put(',');
+  putNum(w); put(',');
+  putNum(h); put(',');
+  putNum(pic);
   FFF();
 }
 
-void Nextion::itemPic(uint8_t id, uint8_t idx)
+bool Nextion::visible(const char *id, uint8_t on)
 {
-  Serial.print(String("p") + id + ".pic=" + idx);
-  FFF();
+  return setProp(id, NP_VIS, on);
+}
+
+bool Nextion::itemPic(uint8_t id, uint8_t idx)
+{
+  return setProp('p', id, NP_PIC, idx);
 }
 
 void Nextion::brightness(uint8_t level)
@@ -84,11 +165,15 @@ void Nextion::brightness(uint8_t level)
   m_newBrightness = level;
 }
 
-void Nextion::setPage(String sPage)
+void Nextion::setPage(const char *pPage)
 {
-  Serial.print(String("page ") + sPage);
+  emitProps(); // changes for the old page go first
+  put("page ");
+  put(pPage);
   FFF();
-  switch(sPage.charAt(0))
+  invalidate(); // new page has its own (unknown) values
+  m_pageBytes = 0;
+  switch(pPage[0])
   {
     case 'T': m_page = Page_Thermostat; break;  // Theromosat
     case 'c': m_page = Page_Clock; break;  // clock (analog)
@@ -104,53 +189,391 @@ uint8_t Nextion::getPage()
   return m_page;
 }
 
-void Nextion::gauge(uint8_t id, uint16_t angle)
+bool Nextion::gauge(uint8_t id, uint16_t angle)
 {
-  Serial.print(String("z") + id + ".val=" + angle);
-  FFF();
+  return setProp('z', id, NP_VAL, angle);
 }
 
-void Nextion::backColor(String sPageName, uint16_t color)
+void Nextion::backColor(const char *pPageName, uint16_t color)
 {
-  Serial.print(sPageName + ".bco=" + color);
+  emitProps();
+  put(pPageName);
+  put(".bco=");
+  putNum(color);
   FFF();
 }
 
-void Nextion::itemColor(String s, uint16_t color)
+bool Nextion::itemColor(const char *id, uint16_t color)
 {
-  Serial.print(s + ".pco=" + color);
-  FFF();
+  return setProp(id, NP_PCO, color);
 }
 
 void Nextion::cls(uint16_t color)
 {
-  Serial.print(String("cls ") + color);
+  emitProps();
+  put("cls ");
+  putNum(color);
   FFF();
 }
 
 void Nextion::add(uint8_t comp, uint8_t ch, uint16_t val)
 {
-  Serial.print(String("add ") + comp + "," + ch + "," + val);
+  emitProps();
+  put("add ");
+  putNum(comp); put(',');
+  putNum(ch); put(',');
+  putNum(val);
   FFF();
 }
 
 void Nextion::refresh(bool bOn)
 {
-  Serial.print(String( bOn ? "ref_star":"ref_stop"));
+  emitProps();
+  put( bOn ? "ref_star":"ref_stop" );
   FFF();
 }
 
 void Nextion::reset()
 {
-  Serial.print("rest");
-  FFF();  
+  emitProps();
+  put("rest");
+  FFF();
 }
 
 void Nextion::FFF()
 {
-  Serial.write(0xFF);
-  Serial.write(0xFF);
-  Serial.write(0xFF);
+  put((char)0xFF);
+  put((char)0xFF);
+  put((char)0xFF);
+  queueCmd();
+  if(!m_batch)
+    commit();
+}
+
+// Hold commands while batching (nestable), send when the outermost batch ends
+void Nextion::batch(bool bOn)
+{
+  if(bOn)
+    m_batch++;
+  else if(m_batch && --m_batch == 0)
+    flush();
+}
+
+void Nextion::flush()
+{
+  emitProps();
+  queueCmd();
+  commit();
+}
+
+void Nextion::sync()
+{
+  flush();
+  drain(true);
+}
+
+uint16_t Nextion::queued()
+{
+  return (m_qHead - m_qTail) & (NEX_TXQ-1);
+}
+
+uint16_t Nextion::room()
+{
+  return NEX_TXQ - 1 - queued();
+}
+
+// time the panel needs after a command before it can take the next one
+static const struct
+{
+  char cmd[5];
+  uint8_t ms;
+} nexPause[] =
+{
+  {"ref ", 8},  // component redraw (clock face)
+  {"page", 25},
+  {"cls ", 10},
+  {"xstr", 2},
+  {"line", 1},
+  {"fill", 1},
+  {"crop", 1},
+};
+
+// move the encoded command into the queue
+void Nextion::queueCmd()
+{
+  if(m_len == 0)
+    return;
+
+  uint8_t pause = 0;
+  for(uint8_t i = 0; i < sizeof(nexPause) / sizeof(nexPause[0]); i++)
+    if(!memcmp(m_buf, nexPause[i].cmd, 4))
+    {
+      pause = nexPause[i].ms;
+      break;
+    }
+
+  uint16_t len = m_len;
+  if(len > 255) // the rest goes as the next entry
+  {
+    len = 255;
+    pause = 0;
+  }
+
+  while(NEX_TXQ - 1 - queued() < len + 2) // full, send some now
+  {
+    commit();
+    drain(true);
+  }
+
+  m_q[m_qHead] = pause;
+  m_qHead = (m_qHead + 1) & (NEX_TXQ-1);
+  m_q[m_qHead] = len;
+  m_qHead = (m_qHead + 1) & (NEX_TXQ-1);
+  for(uint16_t i = 0; i < len; i++)
+  {
+    m_q[m_qHead] = m_buf[i];
+    m_qHead = (m_qHead + 1) & (NEX_TXQ-1);
+  }
+  m_txBytes += len;
+  m_pageBytes += len;
+  if(queued() > m_qPeak)
+    m_qPeak = queued();
+
+  m_len -= len;
+  if(m_len)
+  {
+    memmove(m_buf, m_buf + len, m_len);
+    queueCmd();
+  }
+}
+
+// release what has been queued for sending
+void Nextion::commit()
+{
+  if(m_qCommit == m_qHead)
+    return;
+  if(m_drainStart == 0)
+    m_drainStart = millis() | 1;
+  m_qCommit = m_qHead;
+}
+
+// send whole commands as the panel is ready for them, bWait = block until empty
+void Nextion::drain(bool bWait)
+{
+  while(m_qTail != m_qCommit)
+  {
+    uint8_t len = m_q[(m_qTail + 1) & (NEX_TXQ-1)];
+
+    if((long)(millis() - m_txReady) < 0 || Serial.availableForWrite() < ((len < NEX_FIFO) ? len : NEX_FIFO) )
+    {
+      if(!bWait)
+        return;
+      yield(); // let WiFi run while the panel catches up
+      delayMicroseconds(100);
+      continue;
+    }
+
+    uint8_t pause = m_q[m_qTail];
+    uint16_t idx = (m_qTail + 2) & (NEX_TXQ-1);
+    uint16_t n = NEX_TXQ - idx; // contiguous part
+    if(n > len) n = len;
+    Serial.write(m_q + idx, n);
+    if(n < len)
+      Serial.write(m_q, len - n); // wrapped
+    m_qTail = (idx + len) & (NEX_TXQ-1);
+    m_txReady = millis() + pause + len / 12; // 11.5 bytes per ms at 115200
+  }
+
+  if(m_drainStart)
+  {
+    m_drainTime = millis() - m_drainStart;
+    m_drainStart = 0;
+  }
+}
+
+void Nextion::invalidate()
+{
+  memset(m_props, 0, sizeof(m_props));
+  m_bHeld = false;
+}
+
+void Nextion::put(char c)
+{
+  if(m_len >= NEX_BUF)
+    queueCmd(); // a partial command is fine, it's all one stream
+  m_buf[m_len++] = c;
+}
+
+void Nextion::put(const char *s)
+{
+  while(*s)
+    put(*s++);
+}
+
+// format an integer straight into the buffer
+void Nextion::putNum(int32_t n)
+{
+  char sz[12];
+  uint8_t i = 0;
+  uint32_t u = (n < 0) ? -n : n;
+
+  if(n < 0)
+    put('-');
+  do{
+    sz[i++] = '0' + (u % 10);
+    u /= 10;
+  }while(u);
+  while(i)
+    put(sz[--i]);
+}
+
+void Nextion::putItem(char type, uint8_t id, const char *pProp)
+{
+  put(type);
+  putNum(id);
+  put(pProp);
+}
+
+// find the model entry, or a free one (type = 0) if not there
+nexProp *Nextion::findProp(char type, uint8_t id, uint8_t prop)
+{
+  nexProp *pFree = NULL;
+
+  for(uint8_t i = 0; i < NEX_PROPS; i++)
+  {
+    nexProp *p = &m_props[i];
+    if(p->type == type && p->id == id && p->prop == prop)
+      return p;
+    if(p->type == 0 && pFree == NULL)
+      pFree = p;
+  }
+  return pFree;
+}
+
+bool Nextion::setProp(char type, uint8_t id, uint8_t prop, int32_t val)
+{
+  nexProp *p = findProp(type, id, prop);
+
+  if(p == NULL) // model full, just send it
+  {
+    emitProps(); // after the changes already held
+    nexProp tmp;
+    tmp.type = type; tmp.id = id; tmp.prop = prop; tmp.val = val;
+    putProp(&tmp);
+    FFF();
+    return true;
+  }
+  if(p->type && p->val == val)
+  {
+    m_propSkipped++;
+    return false;
+  }
+  p->type = type; p->id = id; p->prop = prop;
+  p->val = val;
+  p->bDirty = true;
+  m_bHeld = true;
+  if(!m_batch)
+    flush();
+  return true;
+}
+
+bool Nextion::setProp(char type, uint8_t id, uint8_t prop, const char *t)
+{
+  nexProp *p = findProp(type, id, prop);
+
+  if(p && p->type && !strcmp(p->sz, t))
+  {
+    m_propSkipped++;
+    return false;
+  }
+  if(p == NULL || strlen(t) >= NEX_TXT) // no room, send as is and forget it
+  {
+    if(p)
+    {
+      p->type = 0;
+      p->bDirty = false;
+    }
+    emitProps(); // after the changes already held
+    putItem(type, id, ".txt=\"");
+    put(t);
+    put('"');
+    FFF();
+    m_propSent++;
+    return true;
+  }
+  p->type = type; p->id = id; p->prop = prop;
+  strcpy(p->sz, t);
+  p->bDirty = true;
+  m_bHeld = true;
+  if(!m_batch)
+    flush();
+  return true;
+}
+
+// by name, "p4" = type 'p', id 4
+bool Nextion::setProp(const char *name, uint8_t prop, int32_t val)
+{
+  return setProp(name[0], atoi(name + 1), prop, val);
+}
+
+void Nextion::putProp(nexProp *p)
+{
+  switch(p->prop)
+  {
+    case NP_TXT:
+      putItem(p->type, p->id, ".txt=\"");
+      put(p->sz);
+      put('"');
+      break;
+    case NP_FP:
+      putItem(p->type, p->id, ".txt=\"");
+      putNum(p->val / 10);
+      put('.');
+      putNum(p->val % 10);
+      put('"');
+      break;
+    case NP_VAL:
+      putItem(p->type, p->id, ".val=");
+      putNum(p->val);
+      break;
+    case NP_PIC:
+      putItem(p->type, p->id, ".pic=");
+      putNum(p->val);
+      break;
+    case NP_PCO:
+      putItem(p->type, p->id, ".pco=");
+      putNum(p->val);
+      break;
+    case NP_VIS:
+      put("vis ");
+      put(p->type);
+      putNum(p->id);
+      put(',');
+      putNum(p->val);
+      break;
+  }
+  m_propSent++;
+}
+
+// add the changed properties to the buffer
+// Also done before each draw command in a batch, so everything goes out in the order it was done
+void Nextion::emitProps()
+{
+  if(!m_bHeld)
+    return;
+  m_bHeld = false;
+  m_batch++; // hold the writes until the caller commits
+  for(uint8_t i = 0; i < NEX_PROPS; i++)
+  {
+    nexProp *p = &m_props[i];
+    if(p->type && p->bDirty)
+    {
+      putProp(p);
+      FFF();
+      p->bDirty = false;
+    }
+  }
+  m_batch--;
 }
 
 void Nextion::dimmer()
@@ -164,6 +587,8 @@ void Nextion::dimmer()
   else
     m_brightness = m_newBrightness;
 
-  Serial.print(String("dim=") + m_brightness);
+  emitProps();
+  put("dim=");
+  putNum(m_brightness);
   FFF();
 }
@@ -17,35 +17,116 @@ enum Page
   Page_Blank,
 };
 
+#define NEX_BUF 256  // command encoder buffer (one command)
+#define NEX_TXQ 2048 // output queue, power of 2.  Drained from service() at the panel's pace, a full queue
+                     // waits in queueCmd, so long drawings are split up to stay under it (see room())
+#define NEX_FIFO 128 // UART hardware FIFO
+#define NEX_RX   64  // longest event (string returns are cut to fit)
+#define NEX_PROPS 32 // retained component properties for the current page (the Thermostat page uses 23, SSID up to 15)
+#define NEX_TXT   12 // longest retained text + 1, fits "12:00:00 PM" (longer text is always sent)
+
+enum NexProp
+{
+  NP_TXT,
+  NP_FP,  // txt as 12.3
+  NP_VAL,
+  NP_PIC,
+  NP_PCO,
+  NP_VIS,
+};
+
+// shadow of one component property as last sent to the panel
+struct nexProp
+{
+  char    type;  // component name prefix ('t', 'p', 'f'...), 0 = unused
+  uint8_t id;    // component number
+  uint8_t prop;  // NexProp
+  bool    bDirty; // changed but not sent yet
+  union
+  {
+    int32_t val;
+    char    sz[NEX_TXT];
+  };
+};
+
 class Nextion
 {
 public:
   Nextion(){};
-  int service(char *pBuff);
-  void itemText(uint8_t id, String t);
-  void btnText(uint8_t id, String t);
-  void itemFp(uint8_t id, uint16_t val);
-  void refreshItem(String id);
+  int service(char *pBuff); // returns the length of a complete event copied to pBuff (NEX_RX size), or 0
+  // Property writes go to the model and return true if the value changed
+  // Only changes are sent, at once or in a batch before the next draw command or at its end
+  bool itemText(uint8_t id, const char *t);
+  bool btnText(uint8_t id, const char *t);
+  bool itemFp(uint8_t id, uint16_t val);
+  void refreshItem(const char *id);
   void fill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
   void line(uint16_t x, uint16_t y, uint16_t x2, uint16_t y2, uint16_t color);
-  void text(uint16_t x, uint16_t y, uint16_t xCenter, uint16_t color, String sText);
-  void visible(String id, uint8_t on);
-  void itemPic(uint8_t id, uint8_t idx);
-  void itemNum(uint8_t item, int16_t num);
+  void crop(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t pic);
+  void text(uint16_t x, uint16_t y, uint16_t xCenter, uint16_t color, const char *pText);
+  bool visible(const char *id, uint8_t on);
+  bool itemPic(uint8_t id, uint8_t idx);
+  bool itemNum(uint8_t item, int16_t num);
   void brightness(uint8_t level);
-  void setPage(String sPage);
+  void setPage(const char *pPage);
   uint8_t getPage(void);
-  void gauge(uint8_t id, uint16_t angle);
-  void backColor(String sPageName, uint16_t color);
-  void itemColor(String s, uint16_t color);
+  bool gauge(uint8_t id, uint16_t angle);
+  void backColor(const char *pPageName, uint16_t color);
+  bool itemColor(const char *id, uint16_t color);
   void cls(uint16_t color);
   void add(uint8_t comp, uint8_t ch, uint16_t val);
   void refresh(bool bOn);
   void reset(void);
   void FFF(void);
+  void batch(bool bOn); // true = hold commands until batch(false)
+  void flush(void);     // queue changed properties and release held commands
+  void sync(void);      // flush and wait for the queue to empty
+  void invalidate(void); // forget the model (panel state unknown), done on page change
+  uint16_t queued(void); // bytes waiting in the queue
+  uint16_t room(void);   // bytes that can be queued without waiting
+
+  uint32_t m_txBytes = 0; // total bytes sent
+  uint16_t m_pageBytes = 0; // bytes sent since the last page change (refresh cost)
+  uint16_t m_propSent = 0; // property writes sent
+  uint16_t m_propSkipped = 0; // property writes suppressed (no change)
+  uint16_t m_qPeak = 0;   // deepest the queue has been
+  uint16_t m_drainTime = 0; // ms to empty the queue last time
+  uint16_t m_rxErrors = 0;  // bad frames and error codes from the panel
 private:
   void dimmer(void);
+  bool rxByte(uint8_t c);
+  void put(char c);
+  void put(const char *s);
+  void putNum(int32_t n);
+  void putItem(char type, uint8_t id, const char *pProp); // "t1.txt="
+  void queueCmd(void);
+  void commit(void);
+  void drain(bool bWait);
+  nexProp *findProp(char type, uint8_t id, uint8_t prop);
+  bool setProp(char type, uint8_t id, uint8_t prop, int32_t val);
+  bool setProp(char type, uint8_t id, uint8_t prop, const char *t);
+  bool setProp(const char *name, uint8_t prop, int32_t val);
+  void putProp(nexProp *p);
+  void emitProps(void);
+
+  nexProp  m_props[NEX_PROPS];
 
+  char     m_buf[NEX_BUF];
+  uint16_t m_len = 0;
+  uint8_t  m_batch = 0;
+  bool     m_bHeld = false; // property changes waiting in a batch
+  // queue entries are [pause ms][length][command bytes]
+  uint8_t  m_q[NEX_TXQ];
+  uint16_t m_qHead = 0;   // write position
+  uint16_t m_qCommit = 0; // end of what can be sent
+  uint16_t m_qTail = 0;   // read position
+  unsigned long m_txReady = 0;   // millis() when the panel can take more
+  unsigned long m_drainStart = 0;
+  // input frame state
+  uint8_t  m_rx[NEX_RX];
+  uint8_t  m_rxLen = 0;  // bytes of the current event (code + data)
+  uint8_t  m_rxNeed;     // data bytes for the code, or NEX_RXSTR for a string
+  uint8_t  m_rxFF = 0;   // terminator 0xFFs seen
   uint8_t m_brightness = 99;
   uint8_t m_newBrightness = 99;
   uint8_t m_page;
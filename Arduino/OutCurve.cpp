@@ -0,0 +1,98 @@
+#include "OutCurve.h"
+
+OutCurve outCurve;
+
+void OutCurve::build(const Forecast *pFc, uint8_t cnt)
+{
+  uint32_t tm[FC_CNT];
+  int16_t  y[FC_CNT];  // temp*10
+  int32_t  d[FC_CNT];  // segment slope, temp*10 per step *256
+  int32_t  m[FC_CNT];  // tangent at each point, same units
+  uint8_t  n = 0;
+
+  m_cnt = 0;
+  for(uint8_t i = 0; i < cnt; i++) // points in time order
+  {
+    if(pFc[i].tm == 0)
+    {
+      if(i) break; // end
+      continue;    // no history entry yet
+    }
+    if(n && pFc[i].tm <= tm[n-1]) // history copy that isn't older, or out of order
+    {
+      if(n > 1) continue;
+      n = 0; // replace the history entry
+    }
+    tm[n] = pFc[i].tm;
+    y[n] = pFc[i].temp * 10;
+    n++;
+  }
+  if(n < 2)
+    return;
+
+  for(uint8_t k = 0; k < n - 1; k++)
+  {
+    int32_t h = (tm[k+1] - tm[k]) / OC_STEP;
+    if(h == 0) h = 1;
+    d[k] = ((int32_t)(y[k+1] - y[k]) << 8) / h;
+  }
+
+  // harmonic mean of the slopes each side keeps it monotone between points (Fritsch-Butland)
+  m[0] = d[0];
+  m[n-1] = d[n-2];
+  for(uint8_t k = 1; k < n - 1; k++)
+  {
+    if((d[k-1] > 0 && d[k] > 0) || (d[k-1] < 0 && d[k] < 0))
+      m[k] = 2 * d[k-1] * (int64_t)d[k] / (d[k-1] + d[k]);
+    else
+      m[k] = 0; // peak or flat
+  }
+
+  m_start = tm[0];
+  uint8_t k = 0;
+  for(m_cnt = 0; m_cnt < OC_CNT; m_cnt++)
+  {
+    uint32_t t = m_start + (uint32_t)m_cnt * OC_STEP;
+    while(k < n - 2 && t >= tm[k+1])
+      k++;
+    if(t > tm[n-1])
+      break;
+
+    int32_t h = (tm[k+1] - tm[k]) / OC_STEP;
+    if(h == 0) h = 1;
+    int32_t u = ((t - tm[k]) << 12) / (tm[k+1] - tm[k]); // 0~4096
+    int32_t u2 = (u * u) >> 12;
+    int32_t u3 = (u2 * u) >> 12;
+
+    int32_t h00 = 2*u3 - 3*u2 + 4096; // Hermite basis *4096
+    int32_t h10 = u3 - 2*u2 + u;
+    int32_t h01 = 3*u2 - 2*u3;
+    int32_t h11 = u3 - u2;
+
+    int32_t v = h00 * y[k] + h01 * y[k+1] + ((h10 * (m[k] * h >> 8) + h11 * (m[k+1] * h >> 8)));
+    m_t[m_cnt] = (v + 2048) >> 12;
+  }
+}
+
+bool OutCurve::valid()
+{
+  return (m_cnt >= 2);
+}
+
+// 0 if there's no curve, check valid() first
+int16_t OutCurve::get(uint32_t tm, bool bDelayed)
+{
+  if(m_cnt == 0) // not built, or fewer than 2 forecast points
+    return 0;
+  if(bDelayed)
+    tm -= 3 * 3600;
+  if(tm <= m_start)
+    return m_t[0];
+
+  uint32_t idx = (tm - m_start) / OC_STEP;
+  if(idx >= m_cnt - 1u)
+    return m_t[m_cnt - 1];
+
+  int16_t frac = (tm - m_start) % OC_STEP;
+  return m_t[idx] + (int32_t)(m_t[idx+1] - m_t[idx]) * frac / OC_STEP;
+}
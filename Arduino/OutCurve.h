@@ -0,0 +1,27 @@
+#ifndef OUTCURVE_H
+#define OUTCURVE_H
+
+#include <Arduino.h>
+#include "display.h" // Forecast
+
+#define OC_STEP 600  // seconds per table entry (10 minutes)
+#define OC_CNT  768  // 128 hours
+
+// Outdoor temperature curve, made once per forecast.  Monotone cubic between the forecast
+// points (no overshoot past them) in temp*10, looked up with integer math only
+class OutCurve
+{
+public:
+  OutCurve(){}
+  void build(const Forecast *pFc, uint8_t cnt); // cnt = entries in pFc, [0] is the older history entry (tm 0 if none)
+  bool valid(void);  // built from at least 2 points
+  int16_t get(uint32_t tm, bool bDelayed = false); // temp*10 at time (same base as Forecast.tm), bDelayed = 3 hours earlier (summer curve)
+private:
+  uint32_t m_start; // time of m_t[0]
+  uint16_t m_cnt;
+  int16_t  m_t[OC_CNT];
+};
+
+extern OutCurve outCurve;
+
+#endif // OUTCURVE_H
@@ -0,0 +1,87 @@
+#include "PolyLine.h"
+#include "Nextion.h"
+
+uint16_t PolyLine::m_inCnt;
+uint16_t PolyLine::m_outCnt;
+
+void PolyLine::start(int16_t x, int16_t y, uint16_t color)
+{
+  m_sx = m_lx = x;
+  m_sy = m_ly = y;
+  m_dir = 0;
+  m_color = color;
+}
+
+void PolyLine::add(int16_t x, int16_t y, uint16_t color)
+{
+  m_inCnt++;
+
+  int16_t dx = x - m_sx;
+  int8_t dir = (dx > 0) ? 1 : -1;
+
+  if(color != m_color || dx == 0 || (m_dir && dir != m_dir) ) // can't extend, start over at the last point
+  {
+    emit();
+    m_color = color;
+    dx = x - m_sx;
+    dir = (dx > 0) ? 1 : -1;
+  }
+
+  if(dx == 0) // vertical, just draw it
+  {
+    m_lx = x;
+    m_ly = y;
+    m_dir = 0;
+    emit();
+    return;
+  }
+
+  // slope to this point is n/d, allowed window for it is (n-1)/d ~ (n+1)/d (1/2 pixel)
+  int32_t d = 2 * dx * dir;
+  int32_t n = 2 * (y - m_sy) * dir;
+
+  if(m_dir && (n * m_loD < m_loN * d || n * m_hiD > m_hiN * d) ) // outside the window
+  {
+    emit();
+    d = 2 * (x - m_sx) * dir;
+    n = 2 * (y - m_sy) * dir;
+  }
+
+  if(m_dir == 0) // first point of a line
+  {
+    m_dir = dir;
+    m_loN = n - 1; m_loD = d;
+    m_hiN = n + 1; m_hiD = d;
+  }
+  else // narrow the window
+  {
+    if((n - 1) * m_loD > m_loN * d)
+    {
+      m_loN = n - 1; m_loD = d;
+    }
+    if((n + 1) * m_hiD < m_hiN * d)
+    {
+      m_hiN = n + 1; m_hiD = d;
+    }
+  }
+  m_lx = x;
+  m_ly = y;
+}
+
+void PolyLine::end()
+{
+  emit();
+}
+
+// draw from the start to the last point, which becomes the new start
+void PolyLine::emit()
+{
+  if(m_lx != m_sx || m_ly != m_sy)
+  {
+    nex.line(m_sx, m_sy, m_lx, m_ly, m_color);
+    m_outCnt++;
+  }
+  m_sx = m_lx;
+  m_sy = m_ly;
+  m_dir = 0;
+}
@@ -0,0 +1,32 @@
+#ifndef POLYLINE_H
+#define POLYLINE_H
+
+#include <Arduino.h>
+
+// Streaming polyline simplifier for Nextion line drawing
+// Points are merged into one line while every point stays within 1/2 pixel of it (slope cone),
+// so the result is the same at panel resolution with fewer line commands
+// A merged line is sent when it ends (or at end()), so anything the caller draws in between goes
+// under it.  Draw order is up to the caller: end() first if something must stay on top
+class PolyLine
+{
+public:
+  PolyLine(){}
+  void start(int16_t x, int16_t y, uint16_t color);
+  void add(int16_t x, int16_t y, uint16_t color); // color of the segment to this point
+  void end(void);
+
+  static uint16_t m_inCnt;  // segments given (all instances)
+  static uint16_t m_outCnt; // lines sent
+private:
+  void emit(void);
+
+  int16_t  m_sx, m_sy; // start of the current line
+  int16_t  m_lx, m_ly; // last point accepted
+  int8_t   m_dir;      // x direction of the current line, 0 = no points yet
+  uint16_t m_color;
+  int32_t  m_loN, m_loD; // slope window lo/hi as fractions (D > 0)
+  int32_t  m_hiN, m_hiD;
+};
+
+#endif // POLYLINE_H
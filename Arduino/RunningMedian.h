@@ -8,11 +8,13 @@
 //     URL: http://arduino.cc/playground/Main/RunningMedian
 // HISTORY: 0.2.00 first template version by Ronny
 //          0.2.01 added getAverage(uint8_t nMedians, float val)
+//          0.2.02 keep _as sorted on add() instead of sorting per query
 //
 // Released to the public domain
 //
 
 #include <inttypes.h>
+#include <string.h>
 
 template <typename T, int N> class RunningMedian {
 
@@ -30,15 +32,31 @@ public:
         _idx = 0;
     };
 
+    // O(N): drop the evicted value from the sorted copy, then insert the new one
     void add(T value) {
+        uint8_t n = _cnt;
+        if (_cnt >= _size) {
+            T old = _ar[_idx];
+            uint8_t i = 0;
+            while (i < n - 1 && _as[i] != old) i++;
+            memmove(&_as[i], &_as[i+1], (n - 1 - i) * sizeof(T));
+            n--;
+        }
+        else _cnt++;
+
+        uint8_t j = n;
+        while (j > 0 && value < _as[j-1]) {
+            _as[j] = _as[j-1];
+            j--;
+        }
+        _as[j] = value;
+
         _ar[_idx++] = value;
         if (_idx >= _size) _idx = 0; // wrap around
-        if (_cnt < _size) _cnt++;
     };
 
     STATUS getMedian(T& value) {
         if (_cnt > 0) {
-            sort();
             value = _as[_cnt/2];
             return OK;
         }
@@ -61,7 +79,6 @@ public:
             if (_cnt < nMedians) nMedians = _cnt;     // when filling the array for first time
             uint8_t start = ((_cnt - nMedians)/2);
             uint8_t stop = start + nMedians;
-            sort();
             float sum = 0;
             for (uint8_t i = start; i < stop; i++) sum += _as[i];
             value = sum / nMedians;
@@ -72,7 +89,6 @@ public:
 
     STATUS getHighest(T& value) {
         if (_cnt > 0) {
-            sort();
             value = _as[_cnt-1];
             return OK;
         }
@@ -81,7 +97,6 @@ public:
 
     STATUS getLowest(T& value) {
         if (_cnt > 0) {
-            sort();
             value =  _as[0];
             return OK;
         }
@@ -106,23 +121,6 @@ private:
     uint8_t _idx;
     T _ar[N];
     T _as[N];
-    void sort() {
-        // copy
-        for (uint8_t i=0; i< _cnt; i++) _as[i] = _ar[i];
-
-        // sort all
-        for (uint8_t i=0; i< _cnt-1; i++) {
-            uint8_t m = i;
-            for (uint8_t j=i+1; j< _cnt; j++) {
-                if (_as[j] < _as[m]) m = j;
-            }
-            if (m != i) {
-                T t = _as[m];
-                _as[m] = _as[i];
-                _as[i] = t;
-            }
-        }
-    };
 };
 
 #endif
@@ -0,0 +1,156 @@
+#ifndef SENSORFILTER_H
+#define SENSORFILTER_H
+//
+// Compile-time sensor filter chain for temperature/rh values in tenths (723 = 72.3)
+//
+// Each stage is a plain class with:
+//   bool add(int16_t &v); // filter v in place, false = no output yet (chain stops)
+//   void clear(void);
+//
+// Chained with FilterChain<Stage1, Stage2, ...>, which inlines to straight calls (no virtuals)
+//
+
+#include <inttypes.h>
+#include "RunningMedian.h"
+
+// Median window of N samples, averaging the middle AVG values
+template <int N, uint8_t AVG = 1> class MedianStage
+{
+public:
+  bool add(int16_t &v)
+  {
+    m_med.add(v);
+    if(AVG <= 1)
+      return (m_med.getMedian(v) == m_med.OK);
+    float f;
+    if(m_med.getAverage(AVG, f) != m_med.OK)
+      return false;
+    v = (int16_t)(f + ((f < 0) ? -0.5f : 0.5f));
+    return true;
+  }
+  void clear()
+  {
+    m_med.clear();
+  }
+private:
+  RunningMedian<int16_t, N> m_med;
+};
+
+// Exponential moving average, weight of new sample = 1/(2^SHIFT)
+template <uint8_t SHIFT> class EmaStage
+{
+public:
+  bool add(int16_t &v)
+  {
+    if(!m_bInit)
+    {
+      m_acc = (int32_t)v << SHIFT;
+      m_bInit = true;
+    }
+    else
+      m_acc += v - (m_acc >> SHIFT);
+    v = (int16_t)((m_acc + (1 << SHIFT >> 1)) >> SHIFT);
+    return true;
+  }
+  void clear()
+  {
+    m_bInit = false;
+  }
+private:
+  int32_t m_acc;
+  bool    m_bInit = false;
+};
+
+// Rate of change clamp: output moves at most MAXSTEP per sample (rejects spikes)
+template <int16_t MAXSTEP> class RateClamp
+{
+public:
+  bool add(int16_t &v)
+  {
+    if(m_bInit)
+    {
+      if(v > m_last + MAXSTEP) v = m_last + MAXSTEP;
+      else if(v < m_last - MAXSTEP) v = m_last - MAXSTEP;
+    }
+    m_last = v;
+    m_bInit = true;
+    return true;
+  }
+  void clear()
+  {
+    m_bInit = false;
+  }
+private:
+  int16_t m_last;
+  bool    m_bInit = false;
+};
+
+// Scalar Kalman, Q = process noise, R = measurement noise (both in tenths squared)
+// State is fixed point *256, gain is 0~256
+template <uint16_t Q, uint16_t R> class KalmanStage
+{
+public:
+  bool add(int16_t &v)
+  {
+    int32_t z = (int32_t)v << 8;
+    if(!m_bInit)
+    {
+      m_x = z;
+      m_p = (uint32_t)R << 8;
+      m_bInit = true;
+      return true;
+    }
+    uint32_t p = m_p + ((uint32_t)Q << 8);
+    uint32_t k = (p << 8) / (p + ((uint32_t)R << 8));
+    m_x += (int32_t)(((int64_t)(z - m_x) * k) >> 8);
+    m_p = (p * (256 - k)) >> 8;
+    v = (int16_t)((m_x + 128) >> 8);
+    return true;
+  }
+  void clear()
+  {
+    m_bInit = false;
+  }
+private:
+  int32_t  m_x;
+  uint32_t m_p;
+  bool     m_bInit = false;
+};
+
+template <typename... Stages> class FilterChain;
+
+template <> class FilterChain<>
+{
+public:
+  bool add(int16_t &v) { return true; }
+  void clear() {}
+};
+
+template <typename S, typename... Rest> class FilterChain<S, Rest...>
+{
+public:
+  bool add(int16_t &v)
+  {
+    return m_stage.add(v) && m_rest.add(v);
+  }
+  void clear()
+  {
+    m_stage.clear();
+    m_rest.clear();
+  }
+private:
+  S m_stage;
+  FilterChain<Rest...> m_rest;
+};
+
+// Indoor temperature pipeline, used for both the local sensor and remote unit readings
+// median of 21 (averaging the middle 5), then limit to 2.0 per sample
+// Tuned on the host filter test (Tools/HostTests/filter.cpp) to beat the old median of 25 on
+// error, spikes and step response.  An EmaStage after it only added lag there.
+// Sized in samples, not time: with the SHT21 at 4-16 seconds the median spans 84 to 336 seconds.
+// The long span only happens while the reading is steady: a change of 0.2F or more between
+// readings puts it back to 4 seconds, so a step shows after 11 samples, about a minute, either way.
+// Remote unit readings come at the remote's own rate.
+typedef FilterChain< MedianStage<21, 5>, RateClamp<20> > TempFilter;
+
+#endif // SENSORFILTER_H
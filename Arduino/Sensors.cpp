@@ -0,0 +1,149 @@
+#include "Sensors.h"
+
+#ifdef USE_SHT21
+void ShtSensor::init()
+{
+  m_sht.init();
+}
+
+bool ShtSensor::service()
+{
+  if(!m_sht.service())
+    return false;
+  m_temp = m_sht.getTemperatureF() * 10;
+  m_rh = m_sht.getRh() * 10;
+  return true;
+}
+
+void ShtSensor::setActive(bool bActive)
+{
+  m_sht.setActive(bActive);
+}
+#endif
+
+#ifdef USE_DHT
+void DhtSensor::init()
+{
+  m_dht.setup(m_pin, DHT::DHT22);
+  m_mil = millis();
+}
+
+bool DhtSensor::service()
+{
+  if(millis() - m_mil < m_interval)
+    return false;
+  m_mil = millis();
+
+  int16_t temp = m_dht.toFahrenheit(m_dht.getTemperature()) * 10;
+  if(m_dht.getStatus() != DHT::ERROR_NONE)
+    return false;
+  m_temp = temp;
+  m_rh = m_dht.getHumidity() * 10;
+  return true;
+}
+#endif
+
+#ifdef USE_DS18B20
+Ds18Sensor::Ds18Sensor(uint8_t pin, const uint8_t *addr, uint8_t resolution, uint8_t seconds)
+  : Sensor(SF_TEMP, seconds * 1000), m_oneWire(pin), m_ds18(&m_oneWire)
+{
+  memcpy(m_addr, addr, sizeof(DeviceAddress));
+  m_resolution = resolution;
+  m_convDelay = 750 / (1 << (12 - resolution)); // delay based on resolution
+}
+
+void Ds18Sensor::init()
+{
+  m_ds18.setResolution(m_addr, m_resolution);
+  m_ds18.setWaitForConversion(false); // this enables asyncronous calls
+  m_ds18.requestTemperatures(); // fire off the first request
+  m_reqTime = millis();
+  m_bPending = true;
+}
+
+bool Ds18Sensor::service()
+{
+  if(m_bPending)
+  {
+    if(millis() - m_reqTime < m_convDelay)
+      return false;
+    m_bPending = false;
+    m_temp = m_ds18.getTempF(m_addr) * 10;
+    return true;
+  }
+  if(millis() - m_reqTime >= m_interval)
+  {
+    m_ds18.requestTemperatures();
+    m_reqTime = millis();
+    m_bPending = true;
+  }
+  return false;
+}
+#endif
+
+// use = SF_TEMP and/or SF_RH to take from this sensor, weight = temperature weight in the average
+bool SensorList::add(Sensor *pSensor, uint8_t use, uint8_t weight)
+{
+  if(m_cnt >= SENSOR_CNT)
+    return false;
+  m_pSensor[m_cnt] = pSensor;
+  m_use[m_cnt] = use & pSensor->m_flags;
+  m_weight[m_cnt] = weight ? weight : 1;
+  m_cnt++;
+  return true;
+}
+
+void SensorList::init()
+{
+  for(uint8_t i = 0; i < m_cnt; i++)
+    m_pSensor[i]->init();
+}
+
+void SensorList::setActive(bool bActive)
+{
+  for(uint8_t i = 0; i < m_cnt; i++)
+    m_pSensor[i]->setActive(bActive);
+}
+
+bool SensorList::service()
+{
+  bool bNew = false;
+
+  for(uint8_t i = 0; i < m_cnt; i++)
+    if(m_pSensor[i]->service())
+    {
+      m_pSensor[i]->m_read = millis() | 1; // 0 = never read
+      bNew = true;
+    }
+
+  if(!bNew)
+    return false;
+
+  int32_t tSum = 0;
+  int32_t rhSum = 0;
+  uint16_t tCnt = 0;
+  uint8_t rhCnt = 0;
+
+  for(uint8_t i = 0; i < m_cnt; i++)
+  {
+    Sensor *p = m_pSensor[i];
+    if(p->m_read == 0 || millis() - p->m_read > p->m_interval * 4UL) // never read or stale
+      continue;
+    if(m_use[i] & SF_TEMP)
+    {
+      tSum += (int32_t)p->m_temp * m_weight[i];
+      tCnt += m_weight[i];
+    }
+    if(m_use[i] & SF_RH)
+    {
+      rhSum += p->m_rh;
+      rhCnt++;
+    }
+  }
+
+  if(tCnt == 0)
+    return false;
+  m_temp = tSum / tCnt;
+  m_rh = rhCnt ? rhSum / rhCnt : 500; // fake 50%
+  return true;
+}
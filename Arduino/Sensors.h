@@ -0,0 +1,112 @@
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include <Arduino.h>
+
+// Enable any combination of these (all can run at once)
+#define USE_SHT21     // https://github.com/CuriousTech/ESP8266-HVAC/tree/master/Libraries/SHT21
+//#define USE_DHT     // http://www.github.com/markruys/arduino-DHT
+//#define USE_DS18B20 // DallasTemperature from library mamanger
+
+#ifdef USE_SHT21
+#include <SHT21.h>
+#endif
+#ifdef USE_DHT
+#include <DHT.h>
+#endif
+#ifdef USE_DS18B20
+#include <DallasTemperature.h>
+#endif
+
+#define SF_TEMP (1 << 0) // sensor supplies temperature
+#define SF_RH   (1 << 1) // sensor supplies humidity
+
+// Base sensor.  service() is called every loop and must return quickly (no waiting)
+class Sensor
+{
+public:
+  Sensor(uint8_t flags, uint16_t interval)
+  {
+    m_flags = flags;
+    m_interval = interval;
+    m_read = 0;
+  }
+  virtual void init(void){}
+  virtual bool service(void) = 0; // true when m_temp/m_rh have a new reading
+  virtual void setActive(bool bActive){} // HVAC running hint for adaptive sensors
+
+  int16_t  m_temp;      // F *10
+  int16_t  m_rh;        // % *10
+  uint8_t  m_flags;     // SF_TEMP, SF_RH
+  uint16_t m_interval;  // ms between readings
+  unsigned long m_read; // millis() of last good reading
+};
+
+#ifdef USE_SHT21
+class ShtSensor : public Sensor
+{
+public:
+  ShtSensor(uint8_t sda, uint8_t scl, uint8_t fastSeconds, uint8_t slowSeconds) : Sensor(SF_TEMP|SF_RH, slowSeconds * 1000), m_sht(sda, scl, fastSeconds)
+  {
+    m_sht.setInterval(fastSeconds, slowSeconds);
+  }
+  void init(void);
+  bool service(void);
+  void setActive(bool bActive);
+  SHT21 m_sht;
+};
+#endif
+
+#ifdef USE_DHT
+class DhtSensor : public Sensor
+{
+public:
+  DhtSensor(uint8_t pin, uint8_t seconds) : Sensor(SF_TEMP|SF_RH, seconds * 1000){ m_pin = pin; }
+  void init(void);
+  bool service(void); // Note: the DHT library bit-bangs the read (~5ms) once per interval
+private:
+  DHT m_dht;
+  uint8_t m_pin;
+  unsigned long m_mil;
+};
+#endif
+
+#ifdef USE_DS18B20
+class Ds18Sensor : public Sensor
+{
+public:
+  Ds18Sensor(uint8_t pin, const uint8_t *addr, uint8_t resolution, uint8_t seconds);
+  void init(void);
+  bool service(void);
+private:
+  OneWire m_oneWire;
+  DallasTemperature m_ds18;
+  DeviceAddress m_addr;
+  uint8_t  m_resolution;
+  uint16_t m_convDelay; // conversion time for the resolution
+  unsigned long m_reqTime;
+  bool     m_bPending;
+};
+#endif
+
+#define SENSOR_CNT 4
+
+// Runs all the registered sensors and merges their readings
+class SensorList
+{
+public:
+  SensorList(){ m_cnt = 0; }
+  bool add(Sensor *pSensor, uint8_t use = SF_TEMP|SF_RH, uint8_t weight = 1); // use: which values to merge from this sensor
+  void init(void);
+  bool service(void); // true when the merged reading changed
+  void setActive(bool bActive);
+  int16_t m_temp;     // merged F *10
+  int16_t m_rh;       // merged % *10 (50% if no sensor supplies it)
+private:
+  Sensor  *m_pSensor[SENSOR_CNT];
+  uint8_t m_use[SENSOR_CNT];
+  uint8_t m_weight[SENSOR_CNT];
+  uint8_t m_cnt;
+};
+
+#endif // SENSORS_H
@@ -33,15 +33,12 @@ SOFTWARE.
 #include "display.h"
 #include <Wire.h>
 #include "eeMem.h"
-#include "RunningMedian.h"
+#include "SensorFilter.h"
 
 //uncomment to swap Serial's pins to 15(TX) and 13(RX) that don't interfere with booting
 //#define SER_SWAP https://github.com/esp8266/Arduino/blob/master/doc/reference.md
 
-// Uncomment only one of these
-#include <SHT21.h> // https://github.com/CuriousTech/ESP8266-HVAC/tree/master/Libraries/SHT21
-//#include <DHT.h>  // http://www.github.com/markruys/arduino-DHT
-//#include <DallasTemperature.h> //DallasTemperature from library mamanger
+#include "Sensors.h" // select the sensors to build in Sensors.h
 
 //----- Pin Configuration - See HVAC.h for the rest -
 #define ESP_LED   2  //Blue LED on ESP07 (on low) also SCL
@@ -59,24 +56,18 @@ eeMem eemem;
 
 HVAC hvac;
 
-#ifdef SHT21_H
-SHT21 sht(SDA, SCL, 4);
-RunningMedian<int16_t,25> tempMedian; //median over 25 samples at 4s intervals
+#ifdef USE_SHT21
+ShtSensor sht(SDA, SCL, 4, 16); // every 4 seconds when active/changing, up to 16 seconds when steady
 #endif
-#ifdef dht_h
-DHT dht;
-RunningMedian<int16_t,20> tempMedian; //median over 20 samples at 5s intervals
+#ifdef USE_DHT
+DhtSensor dht(SDA, 5);      // every 5 seconds
 #endif
-#ifdef DallasTemperature_h
-const int ds18Resolution = 12;
-DeviceAddress ds18addr = { 0x28, 0xC1, 0x02, 0x64, 0x04, 0x00, 0x00, 0x35 };
-unsigned int ds18delay;
-unsigned long ds18lastreq = 1; //zero is special
-const unsigned int ds18reqdelay = 5000; //request every 5 seconds
-unsigned long ds18reqlastreq;
-OneWire oneWire(2); //pin 2
-DallasTemperature ds18(&oneWire);
+#ifdef USE_DS18B20
+const uint8_t ds18addr[8] = { 0x28, 0xC1, 0x02, 0x64, 0x04, 0x00, 0x00, 0x35 };
+Ds18Sensor ds18(2, ds18addr, 12, 5); // pin 2, 12 bit, every 5 seconds
 #endif
+SensorList sensors;
+TempFilter tempFilter; // see SensorFilter.h (same chain as remote readings)
 
 UdpTime utime;
 
@@ -122,19 +113,16 @@ void setup()
   startServer();
   hvac.init();
   display.init();
-#ifdef SHT21_H
-  sht.init();
+#ifdef USE_SHT21
+  sensors.add(&sht);
 #endif
-#ifdef dht_h
-  dht.setup(SDA, DHT::DHT22);
+#ifdef USE_DHT
+  sensors.add(&dht);
 #endif
-#ifdef DallasTemperature_h
-  ds18.setResolution(ds18addr, ds18Resolution);
-  ds18.setWaitForConversion(false); //this enables asyncronous calls
-  ds18.requestTemperatures(); //fire off the first request
-  ds18lastreq = millis();
-  ds18delay = 750 / (1 << (12 - ds18Resolution)); //delay based on resolution
+#ifdef USE_DS18B20
+  sensors.add(&ds18, SF_TEMP); // e.g. on the return duct with SHT21 for rh: sensors.add(&sht, SF_RH);
 #endif
+  sensors.init();
   utime.start();
 }
 
@@ -154,55 +142,19 @@ void loop()
     if(lastDay == -1)
       lastDay = day() - 1;
   }
-#ifdef SHT21_H
-  if(sht.service())
+  if(sensors.service()) // merged reading of all sensors
   {
-    tempMedian.add(sht.getTemperatureF() * 10);
-    float temp;
-    if (tempMedian.getAverage(2, temp) == tempMedian.OK) {
-      hvac.updateIndoorTemp( temp, sht.getRh() * 10 );
-    }
-  }
-#endif
-#ifdef DallasTemperature_h
-  if(ds18lastreq > 0 && millis() - ds18lastreq >= ds18delay) { //new temp is ready
-    tempMedian.add(ds18.getTempF(ds18addr));
-    ds18lastreq = 0; //prevents this block from firing repeatedly
-    float temp;
-    if (tempMedian.getMedian(temp) == tempMedian.OK) {
-      hvac.updateIndoorTemp( temp * 10, 500); //fake 50%
-    }
+    int16_t temp = sensors.m_temp;
+    if(tempFilter.add(temp))
+      hvac.updateIndoorTemp( temp, sensors.m_rh );
   }
-
-  if(millis() - ds18reqlastreq >= ds18reqdelay) {
-    ds18.requestTemperatures(); 
-    ds18lastreq = millis();
-    ds18reqlastreq = ds18lastreq;
-  }
-#endif
   if(sec_save != second()) // only do stuff once per second
   {
     sec_save = second();
     secondsServer(); // once per second stuff
     display.oneSec();
     hvac.service();   // all HVAC code
-
-#ifdef dht_h
-    static uint8_t read_delay = 2;
-    if(--read_delay == 0)
-    {
-      int16_t temp = (dht.toFahrenheit(dht.getTemperature()) * 10);
-
-      if(dht.getStatus() == DHT::ERROR_NONE)
-      {
-        tempMedian.add(temp);
-        if (tempMedian.getAverage(2, temp) == tempMedian.OK) {
-          hvac.updateIndoorTemp( temp, dht.getHumidity() * 10);
-        }
-      }
-      read_delay = 5; // update every 5 seconds
-    }
-#endif
+    sensors.setActive(hvac.getState() || hvac.getFanRunning()); // faster sampling while running
 
     if(min_save != minute()) // only do stuff once per minute
     {
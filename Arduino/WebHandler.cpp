@@ -17,7 +17,11 @@
 #include "HVAC.h"
 #include <JsonParse.h> // https://github.com/CuriousTech/ESP8266-HVAC/tree/master/Libraries/JsonParse
 #include "display.h" // for display.Note()
+#include "Nextion.h"
 #include "eeMem.h"
+#include "HttpLines.h"
+#include "SensorFilter.h"
+#include "Sensors.h"
 #ifdef USE_SPIFFS
 #include <FS.h>
 #include <SPIFFSEditor.h>
@@ -43,17 +47,31 @@ AsyncClient fc_client;
 
 void remoteCallback(int16_t iEvent, uint16_t iName, int iValue, char *psValue);
 JsonParse remoteParse(remoteCallback);
+TempFilter remoteFilter; // remote unit temps get the same filtering as the local sensor
 void fcPage(AsyncWebServerRequest *request);
+void wrongKey(IPAddress ip, const char *pKey);
 
 int xmlState;
 void GetForecast(void);
 
+#ifdef USE_SHT21
+extern ShtSensor sht;
+#endif
+
 int nWrongPass;
 uint32_t lastIP;
 bool bKeyGood;
 int WsClientID;
 int WsRemoteID;
 
+#define BATCH_CNT 48  // settings in one batch
+uint8_t batchCmd[BATCH_CNT]; // setVar index
+int     batchVal[BATCH_CNT];
+uint8_t batchCnt;
+bool    bBatch;       // remoteCallback collects cmd values instead of setting them
+bool    bBatchBad;    // a name that isn't a setting, or too many
+char    batchKey[64]; // the key a batch gave, for the log when wrong
+
 // Handle event stream
 void onEvents(AsyncEventSourceClient *client)
 {
@@ -61,9 +79,9 @@ void onEvents(AsyncEventSourceClient *client)
   if(rebooted)
   {
     rebooted = false;
-    events.send("Restarted", "alert");
+    WsSend("Restarted", "alert");
   }
-  events.send(dataJson().c_str(), "state");
+  WsSend((char*)dataJson().c_str(), "state");
 }
 
 void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len)
@@ -107,7 +125,14 @@ void onWsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventT
           if(pCmd == NULL || pData == NULL) break;
           bKeyGood = false; // for callback (all commands need a key)
           WsClientID = client->id();
-          remoteParse.process(pCmd, pData);
+          if(!strcmp(pCmd, "batch")) // "batch;{key:x,name:value,...}" all or nothing
+          {
+            const char *pErr = batch(pData, client->remoteIP());
+            if(pErr)
+              client->text(String("alert;Settings not changed: ") + pErr);
+          }
+          else
+            remoteParse.process(pCmd, pData);
         }
       }
       break;
@@ -165,6 +190,30 @@ void startServer()
     request->send ( 200, "text/html", "OK" );
   });
 
+  // POST a JSON body {"key":"x","cooltemph":850,...}, same as the "batch;" WebSocket command
+  server.on ( "/batch", HTTP_POST, [](AsyncWebServerRequest *request){
+    if(request->_tempObject == NULL)
+    {
+      request->send ( 400, "text/html", "No data or too big" );
+      return;
+    }
+    const char *pErr = batch((char *)request->_tempObject, request->client()->remoteIP());
+    if(pErr)
+      request->send ( 400, "text/html", pErr );
+    else
+      request->send ( 200, "text/html", "OK" );
+  }, NULL, [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total){
+    if(total > 1024) // too big for a batch
+      return;
+    if(index == 0)
+      request->_tempObject = malloc(total + 1); // freed with the request
+    if(request->_tempObject == NULL)
+      return;
+    memcpy((char *)request->_tempObject + index, data, len);
+    if(index + len == total)
+      ((char *)request->_tempObject)[total] = 0;
+  });
+
   server.on ( "/json", HTTP_GET | HTTP_POST, [](AsyncWebServerRequest *request){
     String s = hvac.settingsJson();
     request->send ( 200, "text/json", s);
@@ -205,14 +254,52 @@ void startServer()
     request->send(200, "text/plain", String(ESP.getFreeHeap()));
   });
 
+  // display output queue stats
+  server.on("/nex", HTTP_GET, [](AsyncWebServerRequest *request){
+    String s = "{\"queued\":";
+    s += nex.queued();
+    s += ",\"peak\":";
+    s += nex.m_qPeak;
+    s += ",\"drain\":";
+    s += nex.m_drainTime;
+    s += ",\"bytes\":";
+    s += nex.m_txBytes;
+    s += ",\"pageBytes\":";
+    s += nex.m_pageBytes;
+    s += ",\"sent\":";
+    s += nex.m_propSent;
+    s += ",\"skipped\":";
+    s += nex.m_propSkipped;
+    s += ",\"lines\":";
+    s += display.m_poly.m_inCnt;
+    s += ",\"linesSent\":";
+    s += display.m_poly.m_outCnt;
+    s += "}";
+    request->send(200, "text/json", s);
+  });
+
+#ifdef USE_SHT21
+  server.on("/sht", HTTP_GET, [](AsyncWebServerRequest *request){
+    String s = "{\"reads\":";
+    s += sht.m_sht.m_stats.reads;
+    s += ",\"crc\":";
+    s += sht.m_sht.m_stats.crcErrors;
+    s += ",\"noData\":";
+    s += sht.m_sht.m_stats.noData;
+    s += ",\"fails\":";
+    s += sht.m_sht.m_stats.fails;
+    s += "}";
+    request->send(200, "text/json", s);
+  });
+#endif
+
   server.begin();
 
   // Add service to MDNS-SD
   MDNS.addService("http", "tcp", serverPort);
 
-  remoteParse.addList(jsonList1);
-  remoteParse.addList(cmdList);
-  remoteParse.addList(jsonList3);
+  if(!remoteParse.addList(jsonList1) || !remoteParse.addList(cmdList) || !remoteParse.addList(jsonList3))
+    display.Note("JSON lists too big"); // over JP_LISTS or JP_SLOTS, names would be ignored
 
 #ifdef OTA_ENABLE
   ArduinoOTA.begin();
@@ -227,7 +314,24 @@ void startServer()
 // Send the comma delimited forecast data
 void fcPage(AsyncWebServerRequest *request)
 {
+  uint32_t h = 2166136261UL; // FNV-1a of the data for the ETag
+  const uint8_t *p = (const uint8_t *)display.m_fcData;
+  for(unsigned i = 0; i < sizeof(display.m_fcData); i++)
+    h = (h ^ p[i]) * 16777619UL;
+  p = (const uint8_t *)display.m_fcCol;
+  for(unsigned i = 0; i < sizeof(display.m_fcCol); i++)
+    h = (h ^ p[i]) * 16777619UL;
+  char szTag[12];
+  sprintf(szTag, "\"%08x\"", (unsigned)h);
+
+  if(request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == szTag)
+  {
+    request->send(304);
+    return;
+  }
+
   AsyncResponseStream *response = request->beginResponseStream("text/javascript");
+  response->addHeader("ETag", szTag);
 
   for(int i = 0; i < FC_CNT; i++)
   {
@@ -238,6 +342,12 @@ void fcPage(AsyncWebServerRequest *request)
     out += display.m_fcData[i].tm;
     out += ",";
     out += display.m_fcData[i].temp;
+    for(int c = 0; c < FC_COLS; c++) // dew (empty = none)
+    {
+      out += ",";
+      if(display.m_fcCol[c][i] != FC_NONE)
+        out += display.m_fcCol[c][i];
+    }
     out += "\r\n";
     response->print(out);
   }
@@ -254,32 +364,81 @@ void handleServer()
 #endif
 }
 
+// "type;txt" is made once in a buffer the library shares between all the WebSocket clients
+// NULL if there are none, or for the SSE keepalive (empty type)
+AsyncWebSocketMessageBuffer *wsBuffer(const char *type, const char *txt)
+{
+  if(ws.count() == 0 || *type == 0)
+    return NULL;
+  size_t tl = strlen(type);
+  size_t len = strlen(txt);
+  AsyncWebSocketMessageBuffer *buf = ws.makeBuffer(tl + 1 + len); // zero terminated by the library
+  if(buf == NULL)
+    return NULL;
+  uint8_t *p = buf->get();
+  memcpy(p, type, tl);
+  p[tl] = ';';
+  memcpy(p + tl + 1, txt, len);
+  return buf;
+}
+
+// SSE and WebSocket clients get the same bytes, SSE the txt part of the buffer
 void WsSend(char *txt, const char *type)
 {
-  events.send(txt, type);
-  ws.textAll(String(type) + String(";") + String(txt));
+  AsyncWebSocketMessageBuffer *buf = wsBuffer(type, txt);
+  if(buf == NULL)
+  {
+    events.send(txt, type);
+    return;
+  }
+  events.send((char *)buf->get() + strlen(type) + 1, type); // before textAll() can free it
+  ws.textAll(buf);
 }
 
+#define WS_HOLD 5 // seconds state and settings can wait for a slow client
+
 void secondsServer() // called once per second
 {
   if(nWrongPass)
     nWrongPass--;
 
+  static bool bState; // changed since last sent
+  static uint8_t hold;
   static int n = 10;
+
   if(hvac.stateChange() || hvac.tempChange())
+    bState = true;
+
+  // A client with a full queue would drop messages, so hold the latest-value ones back.
+  // State is resent whole and the settings diff keeps adding up, so nothing is lost
+  bool bRoom = ws.availableForWriteAll() && events.avgPacketsWaiting() < 4;
+  if(bRoom || hold >= WS_HOLD)
+    hold = 0;
+  else
+    hold++;
+
+  if(bState && hold == 0)
   {
     WsSend((char*)dataJson().c_str(), "state" );
+    bState = false;
     n = 10;
   }
   else if(--n == 0)
   {
-    events.send("", "" ); // keepalive
+    WsSend("", "" ); // SSE keepalive
     n = 10;
   }
 
-  String s = hvac.settingsJsonMod(); // returns "{}" if nothing has changed
-  if(s.length() > 2)
-    ws.textAll(String("settings;") + s); // update anything changed
+  if(hold == 0)
+  {
+    String s = hvac.settingsJsonMod(); // returns "{}" if nothing has changed
+    if(s.length() > 2)
+    {
+      AsyncWebSocketMessageBuffer *buf = wsBuffer("settings", s.c_str()); // update anything changed
+      if(buf)
+        ws.textAll(buf);
+    }
+  }
 
   if(display.m_bUpdateFcst == true && display.m_bUpdateFcstDone == false)
   {
@@ -287,11 +446,7 @@ void secondsServer() // called once per second
     if(ee.bNotLocalFcst)
       GetForecast();
     else if(fc_client.connected() == false)    // get preformatted data from local server
-    {
-       display.m_fcData[0].temp = display.m_fcData[1].temp; // keep a copy of first 3hr data
-       display.m_fcData[0].tm = display.m_fcData[1].tm;
        fc_client.connect(ipFcServer, nFcPort);
-    }
   }
 
   if(xmlState)
@@ -300,13 +455,19 @@ void secondsServer() // called once per second
       {
         case XML_COMPLETED:
         case XML_DONE:
+        case XML_NOT_MODIFIED:
           hvac.enable();
           display.m_bUpdateFcstDone = true;
           break;
         case XML_TIMEOUT:
           WsSend("Forcast timeout", "print");
-          hvac.disable();
-          hvac.m_notif = Note_Forecast;
+          if(display.fcValid()) // keep going on the last one
+            hvac.enable();
+          else
+          {
+            hvac.disable();
+            hvac.m_notif = Note_Forecast;
+          }
           display.m_bUpdateFcstDone = true;
           break;
       }
@@ -314,71 +475,115 @@ void secondsServer() // called once per second
   }
 }
 
+// one parameter, after the key is known good.  buf is for decoding the value
+static void setParam(AsyncWebParameter* p, char *buf, size_t size)
+{
+  p->value().toCharArray(buf, size);
+  wifi.urldecode(buf);
+  const char *pName = p->name().c_str();
+
+  if(!strcmp(pName, "rest"))
+    display.init();
+  else if(!strcmp(pName, "ssid"))
+  {
+    strncpy(ee.szSSID, buf, sizeof(ee.szSSID));
+    ee.szSSID[sizeof(ee.szSSID) - 1] = 0;
+  }
+  else if(!strcmp(pName, "pass"))
+    wifi.setPass(buf);
+  else if(!strcmp(pName, "fc"))
+  {
+    ee.bNotLocalFcst = atoi(buf) ? true:false;
+    display.m_bUpdateFcst = true;
+  }
+  else
+    hvac.setVar(pName, atoi(buf));
+}
+
+// One pass: anything before the key waits in pending[] until the key is checked
+// If more come before the key than pending[] holds, the rest are read again once it is
 void parseParams(AsyncWebServerRequest *request)
 {
   char temp[100];
-  char password[64];
+  uint8_t pending[24]; // param index
+  uint8_t nPending = 0;
+  bool bKey = false;
 
   if(request->params() == 0)
     return;
 
+  uint32_t ip = request->client()->remoteIP();
+  temp[0] = 0;
+
   for ( uint8_t i = 0; i < request->params(); i++ ) // password may be at end
   {
     AsyncWebParameter* p = request->getParam(i);
-    p->value().toCharArray(temp, 100);
-    String s = wifi.urldecode(temp);
 
-    if(p->name() == "key")
+    if(bKey)
+      setParam(p, temp, sizeof(temp));
+    else if(p->name() == "key")
     {
-      s.toCharArray(password, sizeof(password));
+      p->value().toCharArray(temp, sizeof(temp));
+      wifi.urldecode(temp);
+      if(strcmp(ee.password, temp))
+        break;
+      bKey = true;
+      for(uint8_t j = 0; j < nPending; j++)
+        setParam(request->getParam(pending[j]), temp, sizeof(temp));
+      if(nPending == sizeof(pending)) // second pass for the ones that didn't fit
+        for(uint8_t j = pending[nPending - 1] + 1; j < i; j++)
+          setParam(request->getParam(j), temp, sizeof(temp));
     }
+    else if(nPending < sizeof(pending))
+      pending[nPending++] = i;
   }
 
-  uint32_t ip = request->client()->remoteIP();
+  if(!bKey) // wrong or no key, temp has the wrong one
+    wrongKey(ip, temp);
+  lastIP = ip;
+}
 
-  if(strcmp(ee.password, password))
-  {
-    if(nWrongPass == 0)
-      nWrongPass = 10;
-    else if((nWrongPass & 0xFFFFF000) == 0 ) // time doubles for every high speed wrong password attempt.  Max 1 hour
-      nWrongPass <<= 1;
-    if(ip != lastIP)  // if different IP drop it down
-       nWrongPass = 10;
-    String data = "{\"ip\":\"";
-    data += request->client()->remoteIP().toString();
-    data += "\",\"pass\":\"";
-    data += password; // bug - String object adds a NULL
-    data += "\"}";
-    WsSend((char*)data.c_str(), "hack"); // log attempts
-    lastIP = ip;
-    return;
-  }
+// Back off and log a wrong or missing key
+void wrongKey(IPAddress ip, const char *pKey)
+{
+  if(nWrongPass == 0)
+    nWrongPass = 10;
+  else if((nWrongPass & 0xFFFFF000) == 0 ) // time doubles for every high speed wrong password attempt.  Max 1 hour
+    nWrongPass <<= 1;
+  if((uint32_t)ip != lastIP)  // if different IP drop it down
+     nWrongPass = 10;
+  String data = "{\"ip\":\"";
+  data += ip.toString();
+  data += "\",\"pass\":\"";
+  data += pKey;
+  data += "\"}";
+  WsSend((char*)data.c_str(), "hack"); // log attempts
+}
 
+// Set all the values in a cmd list JSON object together, or none if anything is wrong
+// Returns NULL when applied, otherwise why not.  The key can be anywhere in the object
+const char *batch(char *pData, IPAddress ip)
+{
+  bKeyGood = false;
+  batchKey[0] = 0;
+  bBatchBad = false;
+  batchCnt = 0;
+  bBatch = true;
+  bool bOk = remoteParse.process((char *)"cmd", pData);
+  bBatch = false;
+
+  if(!bOk)
+    return "Bad JSON";
+  if(!bKeyGood)
+    wrongKey(ip, batchKey);
   lastIP = ip;
-
-  for ( uint8_t i = 0; i < request->params(); i++ )
-  {
-    AsyncWebParameter* p = request->getParam(i);
-    p->value().toCharArray(temp, 100);
-    String s = wifi.urldecode(temp);
-
-    if(p->name() == "key");
-    else if(p->name() == "rest")
-      display.init();
-    else if(p->name() == "ssid")
-      s.toCharArray(ee.szSSID, sizeof(ee.szSSID));
-    else if(p->name() == "pass")
-      wifi.setPass(s.c_str());
-    else if(p->name() == "fc")
-    {
-      ee.bNotLocalFcst = s.toInt() ? true:false;
-      display.m_bUpdateFcst = true;
-    }
-    else
-    {
-      hvac.setVar(p->name(), s.toInt() );
-    }
-  }
+  if(!bKeyGood)
+    return "Bad key";
+  if(bBatchBad || remoteParse.m_unknown)
+    return "Unknown or too many names";
+  if(!hvac.setVars(batchCmd, batchVal, batchCnt))
+    return "Value out of range or locked";
+  return NULL;
 }
 
 // Pushed data
@@ -396,7 +601,11 @@ void remoteCallback(int16_t iEvent, uint16_t iName, int iValue, char *psValue)
       {
         case 0: // temp
           if(hvac.m_bRemoteStream)
-            hvac.m_inTemp = (int)(atof(psValue)*10);
+          {
+            int16_t t = (int)(atof(psValue)*10);
+            if(remoteFilter.add(t))
+              hvac.m_inTemp = t;
+          }
           break;
         case 1: // rh
           if(hvac.m_bRemoteStream)
@@ -404,7 +613,11 @@ void remoteCallback(int16_t iEvent, uint16_t iName, int iValue, char *psValue)
           break;
         case 2: // tempi
           if(hvac.m_bRemoteStream)
-            hvac.m_inTemp = iValue;
+          {
+            int16_t t = iValue;
+            if(remoteFilter.add(t))
+              hvac.m_inTemp = t;
+          }
           break;
         case 3: // rhi
           if(hvac.m_bRemoteStream)
@@ -415,6 +628,7 @@ void remoteCallback(int16_t iEvent, uint16_t iName, int iValue, char *psValue)
           {
             WsRemoteID = WsClientID;
             hvac.m_bRemoteStream = (iValue ? true:false);
+            remoteFilter.clear(); // don't mix readings from a previous session
             hvac.m_bLocalTempDisplay = !hvac.m_bRemoteStream; // switch to showing local/remote color
 
             if(hvac.m_bRemoteStream)
@@ -430,6 +644,18 @@ void remoteCallback(int16_t iEvent, uint16_t iName, int iValue, char *psValue)
       {
         if(!strcmp(psValue, ee.password)) // first item must be key
           bKeyGood = true;
+        else if(bBatch)
+          strncpy(batchKey, psValue, sizeof(batchKey) - 1);
+      }
+      else if(bBatch) // keep for batch()
+      {
+        if(iName < 3 || batchCnt >= BATCH_CNT) // data, sum aren't settings
+          bBatchBad = true;
+        else
+        {
+          batchCmd[batchCnt] = iName - 3;
+          batchVal[batchCnt++] = iValue;
+        }
       }
       else if(iName == 1) // 1 = data
       {
@@ -513,7 +739,7 @@ void remoteCallback(int16_t iEvent, uint16_t iName, int iValue, char *psValue)
       else
       {
         if(bKeyGood)
-          hvac.setVar(cmdList[iName+1], iValue); // 4 is "fanmode"
+          hvac.setVar(iName-3, iValue); // iName 3 is "fanmode", no name lookup
       }
       break;
     case 2: // alert
@@ -522,8 +748,12 @@ void remoteCallback(int16_t iEvent, uint16_t iName, int iValue, char *psValue)
   }
 }
 
-// local server forecast retrieval 
+// local server forecast retrieval
+// The response is read into fcNew and only replaces m_fcData when all of a 200 came, a 304 keeps it
 int fcIdx;
+Forecast *fcNew; // scratch, allocated while connected
+void fc_onLine(char *pLine, bool bHeader);
+HttpLines fcLines(fc_onLine);
 
 void fc_onConnect(AsyncClient* client)
 {
@@ -534,44 +764,60 @@ void fc_onConnect(AsyncClient* client)
   s += ipFcServer.toString();
   s += "\n"
     "Connection: close\n"
-    "Accept: */*\n\n";
+    "Accept: */*\n";
+  fcLines.validators(s); // the server can answer 304 if it hasn't changed
+  s += "\n";
 
   fc_client.add(s.c_str(), s.length());
+  if(fcNew == NULL)
+    fcNew = (Forecast *)malloc(sizeof(display.m_fcData));
   fcIdx = 1; // 0 is reserved
+  fcLines.begin();
 }
 
-// read data as comma delimited 'time,temp,rh' per line
-void fc_onData(AsyncClient* client, char* data, size_t len)
+// read data as comma delimited 'time,temp,rh' per line (rh isn't used, and there is no dew point)
+void fc_onLine(char *pLine, bool bHeader)
 {
-  while(fcIdx < FC_CNT-1 && *data)
-  {
-    uint32_t tm = atoi(data);
-    if(tm) // skip the headers
-    {
-      display.m_fcData[fcIdx].tm = tm;
-      while(*data && *data != ',') data ++;
-      if(*data == ',') data ++;
-      else return;
-      display.m_fcData[fcIdx].temp = atoi(data);
-      fcIdx++;
-    }
-    while(*data && *data != '\r' && *data != '\n') data ++;
-    while(*data == '\r' || *data == '\n') data ++;
-  }
-  display.m_fcData[fcIdx].tm = 0;
-  display.m_bUpdateFcstDone = true;
-  hvac.enable();
+  if(bHeader || fcNew == NULL || fcLines.m_status != 200 || fcIdx >= FC_CNT-1)
+    return;
 
-  if(display.m_fcData[0].tm == 0) // initial read
-  {
-    display.m_fcData[0].temp = display.m_fcData[1].temp;
-    display.m_fcData[0].tm = display.m_fcData[1].tm;
-  }
+  uint32_t tm = atoi(pLine);
+  if(tm == 0) // not data
+    return;
+  char *p = strchr(pLine, ',');
+  if(p == NULL)
+    return;
+  fcNew[fcIdx].tm = tm;
+  fcNew[fcIdx].temp = atoi(++p);
+  fcIdx++;
+  fcNew[fcIdx].tm = 0;
+}
+
+void fc_onData(AsyncClient* client, char* data, size_t len)
+{
+  (void)client;
+  fcLines.data(data, len);
 }
 
 void fc_onDisconnect(AsyncClient* client)
 {
   (void)client;
+  fcLines.end();
+  display.m_bUpdateFcstDone = true;
+  hvac.enable();
+  if(fcNew && fcIdx > 1 && fcLines.m_status == 200 && fcLines.m_bComplete)
+  {
+    if(display.m_fcData[1].tm) // keep a copy of first 3hr data
+      display.m_fcData[0] = display.m_fcData[1];
+    else // initial read
+      display.m_fcData[0] = fcNew[1];
+    memcpy(display.m_fcData + 1, fcNew + 1, fcIdx * sizeof(Forecast)); // to the end marker
+    memset(display.m_fcCol, FC_NONE, sizeof(display.m_fcCol)); // no dew point from this server
+    display.m_bFcChanged = true;
+    display.m_bFcSave = true;
+  }
+  free(fcNew);
+  fcNew = NULL;
 }
 
 void fc_onTimeout(AsyncClient* client, uint32_t time)
@@ -586,18 +832,21 @@ const XML_tag_t Xtags[] =
   {"creation-date", NULL, NULL, 1},
   {"time-layout", "time-coordinate", "local", FC_CNT * 2 * 3}, // only 3rd value, start/end for each
   {"temperature", "type", "hourly", FC_CNT * 3},
-  // "temperature", "type", "dewpoint"
-  // "temperature", "type", "wind chill"
-  // wind-speed type="sustained"
-  // cloud-amount type="total"
-  // probability-of-precipitation type="floating"
-  // humidity type="relative"
+  {"temperature", "type", "dew point", FC_CNT * 3}, // the rest are in FcCol order
+  // humidity, wind chill, wind-speed sustained, cloud-amount, probability-of-precipitation, hourly-qpf
   // direction type="wind"
-  // hourly-qpf type="floating"
   // weather layout=
   {NULL}
 };
 
+// forecast value to int8, nil = FC_NONE
+int8_t fcNum(const char *p)
+{
+  if(*p == 0)
+    return FC_NONE;
+  return constrain(atoi(p), -127, 127);
+}
+
 void xml_callback(int item, int idx, char *p, char *pTag)
 {
   static tmElements_t tm;
@@ -607,6 +856,8 @@ void xml_callback(int item, int idx, char *p, char *pTag)
   {
     case -1: // done
       xmlState = idx;
+      if(idx == XML_COMPLETED)
+        display.m_bFcSave = true;
       break;
     case 0: // the current local time
       break;
@@ -614,6 +865,7 @@ void xml_callback(int item, int idx, char *p, char *pTag)
       if(idx == 0)     // first item isn't really data
       {
         cnt = 0;
+        memset(display.m_fcCol, FC_NONE, sizeof(display.m_fcCol)); // new data
         break;
       }
 //      if(pTag[0] != 's') // start only
@@ -632,6 +884,7 @@ void xml_callback(int item, int idx, char *p, char *pTag)
       display.m_fcData[cnt].tm = makeTime(tm);
       cnt++;
       display.m_fcData[cnt].tm = 0; // end of data
+      display.m_bFcChanged = true;
       break;
     case 2:                  // temperature
       if(idx == 0)
@@ -640,6 +893,13 @@ void xml_callback(int item, int idx, char *p, char *pTag)
         break;
 
       display.m_fcData[cnt++].temp = atoi(p);
+      display.m_bFcChanged = true;
+      break;
+    default:                 // extra series, same spacing as temperature
+      if((idx % 3) != 0 || item - 3 >= FC_COLS)
+        break;
+      display.m_fcCol[item - 3][idx / 3] = fcNum(p);
+      display.m_bFcChanged = true;
       break;
   }
 }
@@ -9,6 +9,7 @@ void handleServer(void);
 void secondsServer(void);
 String ipString(IPAddress ip);
 void parseParams(AsyncWebServerRequest *request);
+const char *batch(char *pData, IPAddress ip); // settings all at once, NULL = done else the reason
 String sDec(int t); // just 123 to 12.3 string
 String timeFmt(void);
 String dataJson(void);
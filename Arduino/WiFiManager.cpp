@@ -30,6 +30,7 @@ void WiFiManager::autoConnect(char const *apName, const char *pPass) {
   //    DEBUG_PRINT("AutoConnect");
 
   if ( ee.szSSID[0] ) {
+    nex.sync(); // send any queued display output before blocking
     DEBUG_PRINT("Waiting for Wifi to connect");
 
     WiFi.mode(WIFI_STA);
@@ -104,7 +105,7 @@ void WiFiManager::seconds(void) {
   for (int i = 0; i < n; i++)
   {
     if(n < 16)
-      nex.btnText(i, WiFi.SSID(i));
+      nex.btnText(i, WiFi.SSID(i).c_str());
 
     if(WiFi.SSID(i) == ee.szSSID) // found cfg SSID
     {
@@ -141,9 +142,11 @@ String WiFiManager::page()
   return s;
 }
 
-String WiFiManager::urldecode(const char *src)
+// decoded text is never longer, so it's written over the source
+char *WiFiManager::urldecode(char *p)
 {
-    String decoded = "";
+    char *src = p;
+    char *dst = p;
     char a, b;
     while (*src) {
         if ((*src == '%') &&
@@ -162,17 +165,16 @@ String WiFiManager::urldecode(const char *src)
             else
                 b -= '0';
             
-            decoded += char(16*a+b);
+            *dst++ = char(16*a+b);
             src+=3;
         } else if (*src == '+') {
-            decoded += ' ';
-            *src++;
+            *dst++ = ' ';
+            src++;
         } else {
-            decoded += *src;
-            *src++;
+            *dst++ = *src++;
         }
     }
-    decoded += '\0';
+    *dst = 0;
     
-    return decoded;
+    return p;
 }
@@ -33,7 +33,7 @@ public:
     void seconds(void);
     void setSSID(int idx);
     void setPass(const char *p);
-    String urldecode(const char*);
+    char *urldecode(char *p); // in place, returns p
     bool isCfg(void);
 private:
     boolean hasConnected();
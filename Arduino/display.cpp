@@ -6,6 +6,8 @@
 #include <ESP8266mDNS.h> // for WiFi.RSSI()
 #include "eeMem.h"
 #include "WiFiManager.h"
+#include "OutCurve.h"
+#include <FS.h>
 
 Nextion nex;
 extern HVAC hvac;
@@ -14,9 +16,14 @@ extern void WsSend(char *,const char *);
 
 void Display::init()
 {
+  memset(m_fcCol, FC_NONE, sizeof(m_fcCol));
+  fcLoad();
   if(wifi.isCfg() ) // don't interfere with SSID config
     return;
   memset(m_points, 255, sizeof(m_points));
+#ifdef GRAPH_BUTTONS
+  memset(m_hours, 255, sizeof(m_hours));
+#endif
   nex.FFF(); // Just to end any debug strings in the Nextion
   nex.reset();
   screen( true ); // brighten the screen if it just reset
@@ -29,14 +36,16 @@ void Display::oneSec()
 {
   if(wifi.isCfg() )
     return;
-  updateClock();
-  updateRunIndicator(false); // running stuff
+  nex.batch(true);  // send all the small updates as one write
+  updateClock(false);
+  updateRunIndicator(); // running stuff
   displayTime();    // time update every seconds
   updateModes();    // mode, heat mode, fan mode
   updateTemps();    // 
-  updateAdjMode(false); // update touched temp settings
+  updateAdjMode();  // update touched temp settings
   updateNotification(false);
   updateRSSI();     //
+  nex.batch(false);
   if( m_backlightTimer ) // the dimmer thing
   {
     if(--m_backlightTimer == 0)
@@ -51,6 +60,11 @@ void Display::oneSec()
     lastState = hvac.getState();
     lastFan = hvac.getFanRunning();
   }
+  if(m_bFcSave)
+  {
+    m_bFcSave = false;
+    fcSave();
+  }
   if(m_bUpdateFcstDone)
   {
     WsSend("Forecast success", "print");
@@ -68,6 +82,7 @@ void Display::checkNextion() // all the Nextion recieved commands
   String s;
   static uint8_t textIdx = 0;
 
+  drawStep(); // forecast or graph still being drawn
   Lines(); // draw lines at full speed
 
   if(len == 0)
@@ -125,8 +140,7 @@ void Display::checkNextion() // all the Nextion recieved commands
               break;
             case 2: // time
               nex.setPage("clock");
-              delay(10); // 20 works
-              updateClock();
+              updateClock(true);
               break;
             case 12: // DOW
               if(ee.bLock) break;
@@ -173,6 +187,42 @@ void Display::checkNextion() // all the Nextion recieved commands
               break;
           }
           break;
+#ifdef GRAPH_BUTTONS
+        case Page_Graph: // zoom/pan buttons b1~b4, anywhere else goes back
+          switch(btn)
+          {
+            case 1: // zoom in
+              if(m_graphZoom == 0) break;
+              m_graphZoom--;
+              m_graphPan = 0; // back to now
+              nex.setPage("graph"); // clear it
+              fillGraph();
+              break;
+            case 2: // zoom out
+              if(m_graphZoom >= 3) break;
+              m_graphZoom++;
+              m_graphPan = 0;
+              nex.setPage("graph");
+              fillGraph();
+              break;
+            case 3: // older
+              if(m_graphPan >= 12) break; // a week back at 1d
+              m_graphPan++;
+              nex.setPage("graph");
+              fillGraph();
+              break;
+            case 4: // newer
+              if(m_graphPan == 0) break;
+              m_graphPan--;
+              nex.setPage("graph");
+              fillGraph();
+              break;
+            default:
+              screen(true);
+              break;
+          }
+          break;
+#endif
         case Page_SSID: // Selection page t1=ID 2 ~ t16=ID 17
           wifi.setSSID(cBuf[2]-2);
           nex.refreshItem("t0"); // Just to terminate any debug strings in the Nextion
@@ -215,35 +265,22 @@ void Display::checkNextion() // all the Nextion recieved commands
   }
 }
 
-void Display::updateTemps()
+void Display::updateTemps() // only changes are sent
 {
-  static uint16_t last[7];  // only draw changes
-  static bool bRmt = false;
-
   if(nex.getPage())
-  {
-    memset(last, 0, sizeof(last));
-    bRmt = false;
     return;
-  }
-
-  if(bRmt != hvac.showLocalTemp())
-  {
-    bRmt = hvac.showLocalTemp();
-    nex.itemColor("f2", bRmt ? rgb16(31, 0, 15) : rgb16(0, 63, 31));
-    nex.itemColor("f3", bRmt ? rgb16(31, 0, 15) : rgb16(0, 63, 31));
-  }
-
-  uint16_t temp = hvac.showLocalTemp() ? hvac.m_localTemp : hvac.m_inTemp;
-  uint16_t rh = hvac.showLocalTemp() ? hvac.m_localRh : hvac.m_rh;
 
-  if(last[0] != temp)               nex.itemFp(2, last[0] = temp);
-  if(last[1] != rh)                 nex.itemFp(3, last[1] = rh);
-  if(last[2] != hvac.m_targetTemp)  nex.itemFp(4, last[2] = hvac.m_targetTemp);
-  if(last[3] != ee.coolTemp[1])     nex.itemFp(5, last[3] = ee.coolTemp[1]);
-  if(last[4] != ee.coolTemp[0])     nex.itemFp(6, last[4] = ee.coolTemp[0]);
-  if(last[5] != ee.heatTemp[1])     nex.itemFp(7, last[5] = ee.heatTemp[1]);
-  if(last[6] != ee.heatTemp[0])     nex.itemFp(8, last[6] = ee.heatTemp[0]);
+  bool bRmt = hvac.showLocalTemp();
+  nex.itemColor("f2", bRmt ? rgb16(31, 0, 15) : rgb16(0, 63, 31));
+  nex.itemColor("f3", bRmt ? rgb16(31, 0, 15) : rgb16(0, 63, 31));
+
+  nex.itemFp(2, bRmt ? hvac.m_localTemp : hvac.m_inTemp);
+  nex.itemFp(3, bRmt ? hvac.m_localRh : hvac.m_rh);
+  nex.itemFp(4, hvac.m_targetTemp);
+  nex.itemFp(5, ee.coolTemp[1]);
+  nex.itemFp(6, ee.coolTemp[0]);
+  nex.itemFp(7, ee.heatTemp[1]);
+  nex.itemFp(8, ee.heatTemp[0]);
 }
 
 const char *_days_short[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
@@ -251,31 +288,14 @@ const char *_days_short[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
 // time and dow on main page
 void Display::displayTime()
 {
-  static int8_t lastDay = -1;
-
   if(nex.getPage())
-  {
-    lastDay = -1;
     return;  // t7 and t8 are only on thermostat (for now)
-  }
-
-  String sTime = String( hourFormat12() );
-  sTime += ":";
-  if(minute() < 10) sTime += "0";
-  sTime += minute();
-  sTime += ":";
-  if(second() < 10) sTime += "0";
-  sTime += second();
-  sTime += " ";
-  sTime += isPM() ? "PM":"AM";
 
-  nex.itemText(8, sTime);
+  char szTime[16];
+  sprintf(szTime, "%d:%02d:%02d %s", hourFormat12(), minute(), second(), isPM() ? "PM":"AM");
 
-  if(weekday() != lastDay)   // update weekday
-  {
-    lastDay = weekday();
-    nex.itemText(7, _days_short[weekday()-1]);
-  }
+  nex.itemText(8, szTime);
+  nex.itemText(7, _days_short[weekday()-1]);
 }
 
 #define Fc_Left     22
@@ -294,38 +314,13 @@ void Display::drawForecast(bool bRef)
     return;
   }
 
-  int fcCnt;
-  for(fcCnt = 1; fcCnt < FC_CNT; fcCnt++) // get length (0 = end)
-    if(m_fcData[fcCnt].tm == 0)
-      break;
-
-//  fcCnt = min(40, fcCnt); // 5 day limit
-  if(fcCnt > 40) fcCnt = 40;
+  fcStats();
+  int fcCnt = m_fcCnt;
 
   if(bRef)
   {
-    // Update min/max
-    int8_t tmin = m_fcData[0].temp;
-    int8_t tmax = m_fcData[0].temp;
-
-    if(tmin == 0) // initial value
-      tmin = m_fcData[1].temp;
-
-    int rng = fcCnt;
-    if(rng > ee.fcRange) rng = ee.fcRange;
-  
-    // Get min/max of current forecast
-    for(int i = 1; i < rng; i++)
-    {
-      int8_t t = m_fcData[i].temp;
-      if(tmin > t) tmin = t;
-      if(tmax < t) tmax = t;
-    }
-
-    if(tmin == tmax) tmax++;   // div by 0 check
-
-    hvac.m_outMin = tmin;
-    hvac.m_outMax = tmax;
+    hvac.m_outMin = m_fcRangeMin;
+    hvac.m_outMax = m_fcRangeMax;
   }
 
   displayOutTemp(); // update temp for HVAC
@@ -338,96 +333,179 @@ void Display::drawForecast(bool bRef)
     nex.refreshItem("t19");
     nex.refreshItem("t20");
     nex.refreshItem("s0");
-    delay(5);
   }
 
-    // Update min/max
-    int8_t tmin = m_fcData[0].temp;
-    int8_t tmax = m_fcData[0].temp;
-
-    if(tmin == 0) // initial value
-      tmin = m_fcData[1].temp;
+  int8_t tmin = m_fcDispMin;
+  int8_t tmax = m_fcDispMax;
 
-    int rng = fcCnt;
-    if(rng > ee.fcDisplay) rng = ee.fcDisplay;
-
-    // Get min/max of current forecast
-    for(int i = 1; i < rng; i++)
-    {
-      int8_t t = m_fcData[i].temp;
-      if(tmin > t) tmin = t;
-      if(tmax < t) tmax = t;
-    }
-
-    if(tmin == tmax) tmax++;   // div by 0 check
-   
   int16_t y = Fc_Top+1;
   int16_t incy = (Fc_Height-4) / 3;
   int16_t dec = (tmax - tmin)/3;
   int16_t t = tmax;
-  int16_t x;
+
+  char sz[8];
 
   // temp scale
   for(i = 0; i <= 3; i++)
   {
-    nex.text(3, y-6, 0, rgb16(0, 31, 31), String(t)); // font height/2=6?
+    nex.text(3, y-6, 0, rgb16(0, 31, 31), itoa(t, sz, 10)); // font height/2=6?
     y += incy;
     t -= dec;
   }
 
   int hrs = (m_fcData[fcCnt-1].tm - m_fcData[1].tm) / 3600; // normally 180ish hours
-  int day_x = 0;
 
   if((tmax-tmin) == 0 || hrs <= 0) // divide by 0
     return;
 
-  int y2 = Fc_Top+Fc_Height - 1 - (m_fcData[1].temp - tmin) * (Fc_Height-2) / (tmax-tmin);
-  int x2 = Fc_Left;
-  int hOld = 0;
-  int day = weekday()-1;              // current day
+  // the grid, then the line over it, go out from drawStep() as the queue has room
+  m_fd.i = 1;
+  m_fd.x2 = Fc_Left;
+  m_fd.hOld = 0;
+  m_fd.day = weekday()-1;  // current day
+  m_fd.day_x = 0;
+  m_fd.hrs = hrs;
+  m_fd.tmin = tmin;
+  m_fd.tmax = tmax;
+  m_fd.bLine = false;
+  m_drawJob = DJ_Forecast;
+  drawStep();
+}
+
+// x of forecast point i, points are taken in order
+int Display::fcX(int i)
+{
+  int h = m_fcData[i].tm;
+  if(h < m_fcData[i-1].tm) h = m_fcData[i-1].tm; // Todo: temp fix (end of month?)
+  h = (h - m_fcData[1].tm) / 3600;
+  int x = Fc_Left + h * (Fc_Width-1) / m_fd.hrs;
+
+  if(x < Fc_Left) x = m_fd.x2;  // todo: fix this
+  m_fd.x2 = x;
+  return x;
+}
+
+int Display::fcY(int i)
+{
+  return Fc_Top+Fc_Height - 1 - (m_fcData[i].temp - m_fd.tmin) * (Fc_Height-2) / (m_fd.tmax - m_fd.tmin);
+}
+
+// One step of the forecast, false when done
+// The day and noon lines go first, then the red line is drawn over them
+bool Display::fcPoint()
+{
+  int i = m_fd.i++;
 
-  for(i = 1; i < fcCnt; i++) // should be 41 data points
+  if(m_fd.bLine)
   {
-    int y1 = Fc_Top+Fc_Height - 1 - (m_fcData[i].temp - tmin) * (Fc_Height-2) / (tmax-tmin);
-    int h = m_fcData[i].tm;
-    if(h < m_fcData[i-1].tm) h = m_fcData[i-1].tm; // Todo: temp fix (end of month?)
-    h = (h - m_fcData[1].tm) / 3600;
-    int x1 = Fc_Left + h * (Fc_Width-1) / hrs;
+    if(i >= m_fcCnt)
+    {
+      m_poly.end();
+      return false;
+    }
+    m_poly.add(fcX(i), fcY(i), rgb16(31, 0, 0) ); // red
+    return true;
+  }
 
-    if(x2 < Fc_Left) x2 = Fc_Left;  // first point may be history
-    if(x1 < Fc_Left) x1 = x2;  // todo: fix this
-    nex.line(x2, y2, x1, y1, rgb16(31, 0, 0) ); // red
+  if(i >= m_fcCnt) // grid done
+  {
+    m_fd.day_x += 28;
+    if(m_fd.day_x < Fc_Left+Fc_Width - (8*3) )  // last partial day
+      nex.text(m_fd.day_x, Fc_Top+Fc_Height+1, 1, rgb16(0, 63, 31), _days_short[m_fd.day]); // cyan
+    m_fd.i = 1;
+    m_fd.x2 = Fc_Left;
+    m_fd.bLine = true;
+    m_poly.start(Fc_Left, fcY(1), rgb16(31, 0, 0) ); // red
+    return true;
+  }
 
-    h = (m_fcData[i].tm / 3600) % 24; // current hour
-    if(hOld > h) // new day (draw line)
+  int x1 = fcX(i);
+  int h = (m_fcData[i].tm / 3600) % 24; // current hour
+  if(m_fd.hOld > h) // new day (draw line)
+  {
+    nex.line(x1, Fc_Top+1, x1, Fc_Top+Fc_Height-2, rgb16(20, 41, 20) ); // (light gray)
+    if(x1 - 14 > Fc_Left) // fix 1st day too far left
     {
-      nex.line(x1, Fc_Top+1, x1, Fc_Top+Fc_Height-2, rgb16(20, 41, 20) ); // (light gray)
-      if(x1 - 14 > Fc_Left) // fix 1st day too far left
-      {
-        nex.text(day_x = x1 - 27, Fc_Top+Fc_Height+1, 1, rgb16(0, 63, 31), _days_short[day]); // cyan
-      }
-      if(++day > 6) day = 0;
+      nex.text(m_fd.day_x = x1 - 27, Fc_Top+Fc_Height+1, 1, rgb16(0, 63, 31), _days_short[m_fd.day]); // cyan
+    }
+    if(++m_fd.day > 6) m_fd.day = 0;
+  }
+  if( m_fd.hOld < 12 && h >= 12) // noon (dark line)
+  {
+    nex.line(x1, Fc_Top, x1, Fc_Top+Fc_Height, rgb16(12, 25, 12) ); // gray
+  }
+  m_fd.hOld = h;
+  return true;
+}
+
+// Continue the forecast or graph drawing while the queue has room for another step,
+// so a full screen never waits in queueCmd.  Called from checkNextion() every loop
+void Display::drawStep()
+{
+  while(m_drawJob && nex.room() >= DRAW_ROOM)
+  {
+    bool bMore;
+    if(m_drawJob == DJ_Forecast)
+      bMore = (nex.getPage() == Page_Thermostat) && fcPoint();
+    else
+      bMore = (nex.getPage() == Page_Graph) && graphSample();
+    if(!bMore)
+      m_drawJob = DJ_None; // done, or the page changed
+  }
+}
+
+// Length and min/max of the forecast, only redone for new data or a range setting change
+void Display::fcStats()
+{
+  if(!m_bFcChanged && m_fcRangeN == ee.fcRange && m_fcDispN == ee.fcDisplay)
+    return;
+  if(m_bFcChanged)
+    outCurve.build(m_fcData, FC_CNT);
+  m_bFcChanged = false;
+  m_fcRangeN = ee.fcRange;
+  m_fcDispN = ee.fcDisplay;
+  m_fcNext = 1;
+
+  int8_t tmin = m_fcData[0].temp;
+  int8_t tmax = m_fcData[0].temp;
+
+  if(tmin == 0) // initial value
+    tmin = m_fcData[1].temp;
+
+  m_fcRangeMin = m_fcDispMin = tmin;
+  m_fcRangeMax = m_fcDispMax = tmax;
+
+  int i;
+  for(i = 1; i < FC_CNT && m_fcData[i].tm; i++) // length (0 = end) and both min/max in one pass
+  {
+    int8_t t = m_fcData[i].temp;
+    if(i < 40 && i < m_fcRangeN) // 5 day limit
+    {
+      if(m_fcRangeMin > t) m_fcRangeMin = t;
+      if(m_fcRangeMax < t) m_fcRangeMax = t;
     }
-    if( hOld < 12 && h >= 12) // noon (dark line)
+    if(i < 40 && i < m_fcDispN)
     {
-      nex.line(x1, Fc_Top, x1, Fc_Top+Fc_Height, rgb16(12, 25, 12) ); // gray
+      if(m_fcDispMin > t) m_fcDispMin = t;
+      if(m_fcDispMax < t) m_fcDispMax = t;
     }
-    hOld = h;
-    delay(5); // small glitch in drawing
-    x2 = x1;
-    y2 = y1;
   }
-  day_x += 28;
-  if(day_x < Fc_Left+Fc_Width - (8*3) )  // last partial day
-    nex.text(day_x, Fc_Top+Fc_Height+1, 1, rgb16(0, 63, 31), _days_short[day]); // cyan
+  m_fcCnt = (i > 40) ? 40 : i;
+
+  if(m_fcRangeMin == m_fcRangeMax) m_fcRangeMax++;   // div by 0 check
+  if(m_fcDispMin == m_fcDispMax) m_fcDispMax++;
 }
 
-// get value at current minute between hours
-int Display::tween(int8_t t1, int8_t t2, int m, int r)
+// temp*10 at m minutes past m_fcData[i], toward the next entry
+int Display::fcLerp(int i, int m)
 {
-  if(r == 0) r = 1; // div by zero check
-  double t = (double)(t2 - t1) * (m * 100 / r) / 100;
-  return (int)((t + t1) * 10);
+  int t1 = m_fcData[i].temp * 10;
+  if(i >= FC_CNT - 1 || m_fcData[i+1].tm == 0 || m_fcData[i+1].tm <= m_fcData[i].tm)
+    return t1;
+  int r = (m_fcData[i+1].tm - m_fcData[i].tm) / 60; // usually 3 hour range (180 m)
+  if(r == 0) r = 1;
+  m = constrain(m, 0, r);
+  return t1 + (m_fcData[i+1].temp * 10 - t1) * m / r;
 }
 
 void Display::displayOutTemp()
@@ -435,12 +513,18 @@ void Display::displayOutTemp()
   if(m_fcData[1].tm == 0) // not read yet or time not set
     return;
 
+  fcStats();
+
   int iH = 0;
-  int m = minute();
+  int m = 0;
   uint32_t tmNow = now() - ((ee.tz+hvac.m_DST)*3600);
   if( tmNow >= m_fcData[1].tm)
   {
-    for(iH = 1; tmNow > m_fcData[iH].tm && m_fcData[iH].tm && iH < FC_CNT - 1; iH++);
+    iH = m_fcNext; // continue from last time, entries before it are already past
+    if(iH > 1 && tmNow <= m_fcData[iH-1].tm) // time went back
+      iH = 1;
+    for(; tmNow > m_fcData[iH].tm && m_fcData[iH].tm && iH < FC_CNT - 1; iH++);
+    m_fcNext = iH;
     if(iH) iH--; // set iH to current 3 hour frame
     m = (tmNow - m_fcData[iH].tm) / 60;  // offset = minutes past forecast
   }
@@ -452,13 +536,17 @@ void Display::displayOutTemp()
 //    m_bUpdateFcst = true;
   }
 
-  int r = (m_fcData[iH+1].tm - m_fcData[iH].tm) / 60; // usually 3 hour range (180 m)
-  int outTempReal = tween(m_fcData[iH].temp, m_fcData[iH+1].temp, m, r);
-  int outTempDelayed = outTempReal;
-  if(iH) // assume range = 3 hours for a -3 hour delay
+  int outTempReal;
+  int outTempDelayed;
+  if(outCurve.valid())
+  {
+    outTempReal = outCurve.get(tmNow);
+    outTempDelayed = outCurve.get(tmNow, true);
+  }
+  else // too few points for the curve, straight line between the entries
   {
-     r = (m_fcData[iH].tm - m_fcData[iH-1].tm) / 60;
-     outTempDelayed = tween(m_fcData[iH-1].temp, m_fcData[iH].temp, m, r);
+    outTempReal = fcLerp(iH, m);
+    outTempDelayed = iH ? fcLerp(iH - 1, m) : outTempReal; // assume range = 3 hours for a -3 hour delay
   }
 
   if(nex.getPage() == Page_Thermostat)
@@ -466,6 +554,9 @@ void Display::displayOutTemp()
 
   // Summer/winter curve.  Summer is delayed 3 hours
   hvac.updateOutdoorTemp((ee.Mode == Mode_Heat) ? outTempReal : outTempDelayed);
+
+  int8_t dew = fcValue(FC_DEW, tmNow); // for the humidifier
+  hvac.updateOutdoorDew((dew == FC_NONE) ? DEW_NONE : dew * 10);
 }
 
 void Display::Note(char *cNote)
@@ -483,7 +574,7 @@ void Display::updateNotification(bool bRef)
     return;
   note_last = hvac.m_notif;
 
-  String s = "";
+  const char *s = "";
   switch(hvac.m_notif)
   {
     case Note_None:
@@ -508,9 +599,9 @@ void Display::updateNotification(bool bRef)
       break;
   }
   nex.itemText(12, s);
-  if(s != "" && bRef == false) // refresh shouldn't be resent
+  if(s[0] && bRef == false) // refresh shouldn't be resent
   {
-    WsSend((char*)s.c_str(), "alert");
+    WsSend((char*)s, "alert");
   }
 }
 
@@ -539,7 +630,6 @@ bool Display::screen(bool bOn)
     if( bOn == bOldOn )
       return false; // no change occurred
     nex.setPage("Thermostat");
-    delay(25); // 20 works most of the time
     refreshAll();
   }
   else switch(nex.getPage())
@@ -550,12 +640,12 @@ bool Display::screen(bool bOn)
       break;
     case Page_Blank: // lines
       nex.setPage("graph"); // chart thing
+      m_graphPan = 0;
       fillGraph();
       break;
     default:  // probably thermostat
       nex.setPage("clock"); // clock
-      delay(20);
-      updateClock();
+      updateClock(true);
       nex.brightness(NEX_DIM);
       break;
   }
@@ -566,141 +656,247 @@ bool Display::screen(bool bOn)
 // things to update on page change to thermostat
 void Display::refreshAll()
 {
-  updateRunIndicator(true);
+  updateRunIndicator();
   drawForecast(false);
   updateNotification(true);
-  updateAdjMode(true);
+  updateAdjMode();
 }
 
-// Analog clock
-void Display::updateClock()
+// sine of the 60 clock positions (6 degrees each) *1024
+static const int16_t clockSin[60] = {
+      0,   107,   213,   316,   416,   512,   602,   685,   761,   828,
+    887,   935,   974,  1002,  1018,  1024,  1018,  1002,   974,   935,
+    887,   828,   761,   685,   602,   512,   416,   316,   213,   107,
+      0,  -107,  -213,  -316,  -416,  -512,  -602,  -685,  -761,  -828,
+   -887,  -935,  -974, -1002, -1018, -1024, -1018, -1002,  -974,  -935,
+   -887,  -828,  -761,  -685,  -602,  -512,  -416,  -316,  -213,  -107,
+};
+
+// Analog clock.  The face is only refreshed when the minute/hour hands move,
+// otherwise the face picture is cropped back under the old second hand and
+// only the minute/hour hand lines the crop cut into are drawn again
+void Display::updateClock(bool bRef)
 {
   if(nex.getPage() != Page_Clock)
     return;
 
-  nex.refreshItem("cl"); // erases lines
-  delay(8); // 8 works, 5 does not
-  const float x = 159; // center
-  const float y = 120;
-  float x2,y2,x3,y3;
+  uint8_t m = minute();
 
-  cspoint(x2, y2, x, y, minute() * 6, 80);
-  cspoint(x3, y3, x, y, (minute()+5) * 6, 10);
-  nex.line(x3, y3, x2, y2, rgb16(0, 0, 31) ); // (blue) minute
-  cspoint(x3, y3, x, y, (minute()-5) * 6, 10);
-  nex.line(x3, y3, x2, y2, rgb16(0, 0, 31) ); // (blue) minute
+  if(bRef || m != m_clockMin)
+  {
+    nex.refreshItem("cl"); // erases lines
+    m_clockMin = m;
+    clockHand(m * 12, 80, 5*12, 10, rgb16(0, 0, 31), m_handLine); // (blue) minute
+    clockHand((hour() % 12) * 60 + m, 64, 10*12, 10, rgb16(0, 63, 31), m_handLine + 2); // (cyan) hour, moves every minute
+  }
+  else
+  {
+    // The old second hand is cropped back in boxes along it, split at some of these distances.
+    // Each split is tried and the one sending the fewest bytes is used, a crop is about 23 bytes
+    // and each minute/hour hand line a box cuts into is about 28 to draw again
+    static const int8_t pt[] = {-24, -6, 6, 40, 91}; // tail, center (inside the hand bases), out to the tip
+    const uint8_t nPt = sizeof(pt);
+    uint8_t hits[nPt][nPt]; // hand lines cut by the box from pt[i] to pt[j]
+    for(uint8_t i = 0; i < nPt - 1; i++)
+      for(uint8_t j = i + 1; j < nPt; j++)
+      {
+        Line box;
+        secBox(box, pt[i], pt[j]);
+        box.x1--; box.y1--; box.x2++; box.y2++; // hand pixels can sit half a pixel off their line
+        hits[i][j] = 0;
+        for(uint8_t k = 0; k < 4; k++)
+          if(lineHit(box, m_handLine[k]))
+            hits[i][j] |= 1 << k;
+      }
 
-  float a = (hour() + (minute() * 0.00833) ) * 30;
-  cspoint(x2, y2, x, y, a, 64);
-  a = (hour() + (minute() * 0.00833)+2 ) * 30;
-  cspoint(x3, y3, x, y, a, 10);
-  nex.line(x3, y3, x2, y2, rgb16(0, 63, 31) ); // (cyan) hour
-  a = (hour() + (minute() * 0.00833)-2 ) * 30;
-  cspoint(x3, y3, x, y, a, 10);
-  nex.line(x3, y3, x2, y2, rgb16(0, 63, 31) ); // (cyan) hour
+    uint8_t best = 0; // bit i = split at pt[i+1]
+    uint16_t bestCost = 0xFFFF;
+    for(uint8_t split = 0; split < (1 << (nPt - 2)); split++)
+    {
+      uint8_t cut = 0;
+      uint16_t cost = 0;
+      for(uint8_t i = 0, j = 1; j < nPt; j++)
+        if(j == nPt - 1 || (split & (1 << (j - 1))) )
+        {
+          cut |= hits[i][j];
+          cost += 23;
+          i = j;
+        }
+      for(uint8_t k = 0; k < 4; k++)
+        if(cut & (1 << k)) cost += 28;
+      if(cost < bestCost)
+      {
+        bestCost = cost;
+        best = split;
+      }
+    }
 
-  cspoint(x2, y2, x, y, second() * 6, 91);
-  cspoint(x3, y3, x, y, (second()+30) * 6, 24);
-  nex.line(x3, y3, x2, y2, rgb16(31, 0, 0) ); // (red) second
-}
+    uint8_t cut = 0;
+    for(uint8_t i = 0, j = 1; j < nPt; j++)
+      if(j == nPt - 1 || (best & (1 << (j - 1))) )
+      {
+        Line box;
+        secBox(box, pt[i], pt[j]);
+        nex.crop(box.x1, box.y1, box.x2 - box.x1 + 1, box.y2 - box.y1 + 1, CLOCK_PIC);
+        cut |= hits[i][j];
+        i = j;
+      }
+    for(uint8_t k = 0; k < 4; k++)
+    {
+      Line &l = m_handLine[k];
+      if(cut & (1 << k))
+        nex.line(l.x1, l.y1, l.x2, l.y2, (k < 2) ? rgb16(0, 0, 31) : rgb16(0, 63, 31));
+    }
+  }
 
-void Display::cspoint(float &x2, float &y2, float x, float y, float angle, float size)
-{
-  float ang =  M_PI * (180-angle) / 180;
-  x2 = x + size * sin(ang);
-  y2 = y + size * cos(ang);  
+  m_clockSec = second();
+  clockHand(m_clockSec * 12, 91, 0, 24, rgb16(31, 0, 0), NULL); // (red) second
 }
 
-void Display::updateModes() // update any displayed settings
+// pos = 0~719 (12 per clock position), len = tip distance, spread = base offset each side (0 = tail opposite), base = base distance
+// pLines gets the 2 lines drawn when spread isn't 0
+void Display::clockHand(uint16_t pos, uint8_t len, uint8_t spread, uint8_t base, uint16_t color, Line *pLines)
 {
-  const char *sFan[] = {"Auto", "On"};
-  const char *sModes[] = {"Off", "Cool", "Heat", "Auto"};
-  const char *sHeatModes[] = {"HP", "NG", "Auto"};
-  static bool bFan = true; // set these to something other than default to trigger them all
-  static int8_t FanMode = 4;
-  static uint8_t nMode = 10;
-  static uint8_t heatMode = 10;
+  int16_t x2, y2, x3, y3;
 
-  if(nex.getPage())
+  clockPoint(x2, y2, pos, len);
+  if(spread == 0) // straight through the center
   {
-    nMode = heatMode = 10;
+    clockPoint(x3, y3, pos, -base);
+    nex.line(x3, y3, x2, y2, color);
     return;
   }
-
-  if( (FanMode != hvac.getFan() || bFan != hvac.getFanRunning()) && nex.getPage() == Page_Thermostat)
+  for(uint8_t i = 0; i < 2; i++)
   {
-    int idx = 10; // not running
-    FanMode = hvac.getFan();
-    if( bFan = hvac.getFanRunning() )
+    clockPoint(x3, y3, i ? (pos + 720 - spread) : (pos + spread), base);
+    nex.line(x3, y3, x2, y2, color);
+    if(pLines)
     {
-      idx = 11; // running
-      if(FanMode == FM_On)
-        idx = 12; // on and running
+      pLines[i].x1 = x3; pLines[i].y1 = y3;
+      pLines[i].x2 = x2; pLines[i].y2 = y2;
     }
-    nex.itemPic(5, idx);
   }
+}
+
+// crop box around the drawn second hand from distance d1 to d2 (negative = tail side)
+void Display::secBox(Line &box, int8_t d1, int8_t d2)
+{
+  clockPoint(box.x1, box.y1, m_clockSec * 12, d1);
+  clockPoint(box.x2, box.y2, m_clockSec * 12, d2);
+  if(box.x1 > box.x2) { int16_t t = box.x1; box.x1 = box.x2; box.x2 = t; }
+  if(box.y1 > box.y2) { int16_t t = box.y1; box.y1 = box.y2; box.y2 = t; }
+  box.x1--; box.y1--; box.x2++; box.y2++; // line pixels round either way
+}
+
+// sine of pos (0~719) *1024, between the table entries by interpolation (under 0.1 pixel off at the hour hand tip)
+static int32_t clockSin12(uint16_t pos)
+{
+  uint8_t p = pos / 12;
+  uint8_t f = pos % 12;
+  return clockSin[p] + (clockSin[(p + 1) % 60] - clockSin[p]) * f / 12;
+}
+
+// size is negative for the tail side
+void Display::clockPoint(int16_t &x, int16_t &y, uint16_t pos, int8_t size)
+{
+  const int16_t cx = 159; // center
+  const int16_t cy = 120;
 
-  if(nMode != hvac.getSetMode())
+  pos %= 720;
+  if(size < 0)
   {
-    nMode = hvac.getSetMode();
-    nex.itemPic(7, nMode + 13);
+    size = -size;
+    pos = (pos + 360) % 720;
   }
+  x = cx + (size * clockSin12(pos) + 512) / 1024;
+  y = cy - (size * clockSin12((pos + 180) % 720) + 512) / 1024; // cos
+}
+
+// true if line l crosses box (x1,y1 = top left, x2,y2 = bottom right)
+bool Display::lineHit(Line &box, Line &l)
+{
+  if(min(l.x1, l.x2) > box.x2 || max(l.x1, l.x2) < box.x1
+    || min(l.y1, l.y2) > box.y2 || max(l.y1, l.y2) < box.y1)
+    return false;
+
+  // the box corners on both sides of the line (or on it)
+  int32_t dx = l.x2 - l.x1;
+  int32_t dy = l.y2 - l.y1;
+  uint8_t side = 0;
+  for(uint8_t i = 0; i < 4; i++)
+  {
+    int32_t cx = (i & 1) ? box.x2 : box.x1;
+    int32_t cy = (i & 2) ? box.y2 : box.y1;
+    int32_t c = dx * (cy - l.y1) - dy * (cx - l.x1);
+    side |= (c >= 0) ? 1 : 0;
+    side |= (c <= 0) ? 2 : 0;
+  }
+  return side == 3;
+}
+
+void Display::updateModes() // update any displayed settings
+{
+  const char *sFan[] = {"Auto", "On"};
+  const char *sModes[] = {"Off", "Cool", "Heat", "Auto"};
+  const char *sHeatModes[] = {"HP", "NG", "Auto"};
+
+  if(nex.getPage())
+    return;
 
-  if(heatMode != hvac.getHeatMode())
+  int idx = 10; // not running
+  if( hvac.getFanRunning() )
   {
-    heatMode = hvac.getHeatMode();
-    nex.itemPic(8, heatMode + 17);
+    idx = 11; // running
+    if(hvac.getFan() == FM_On)
+      idx = 12; // on and running
   }
+  nex.itemPic(5, idx);
+  nex.itemPic(7, hvac.getSetMode() + 13);
+  nex.itemPic(8, hvac.getHeatMode() + 17);
 }
 
-void Display::updateAdjMode(bool bRef)  // current adjust indicator of the 4 temp settings
+void Display::updateAdjMode()  // current adjust indicator of the 4 temp settings
 {
-  static uint8_t am = 0;
-  static bool bl = false;
-  // p0-p4
-  if(nex.getPage() || (bRef == false && am == m_adjustMode && bl == hvac.m_bLink) )
+  // p0-p3
+  if(nex.getPage())
     return;
-  nex.visible("p" + String(am), 0); // turn off both hi/lo of last
-  nex.visible("p" + String(am^1), 0);
-  am = m_adjustMode;
-  nex.visible("p" + String(am), 1);
-  if(hvac.m_bLink)
-    nex.visible("p" + String(am^1), 1); // turn on the opposite hi/lo
-  bl = hvac.m_bLink;
+  char szP[3] = "p0";
+  for(uint8_t i = 0; i < 4; i++)
+  {
+    szP[1] = '0' + i; // selected, plus the opposite hi/lo if linked
+    nex.visible(szP, (i == m_adjustMode || (hvac.m_bLink && i == (m_adjustMode^1)) ) ? 1:0);
+  }
 }
 
 void Display::updateRSSI()
 {
-  static uint8_t seccnt = 2;
-  static int16_t rssiT;
+  static uint8_t seccnt = 1;
 #define RSSI_CNT 8
   static int16_t rssi[RSSI_CNT];
   static uint8_t rssiIdx = 0;
 
-  if(nex.getPage()) // must be page 0
+  if(--seccnt == 0)
   {
-    rssiT = 0; // cause a refresh later
-    seccnt = 1;
-    return;
+    seccnt = 3;     // sample every 3 seconds
+    rssi[rssiIdx] = WiFi.RSSI();
+    if(++rssiIdx >= RSSI_CNT) rssiIdx = 0;
   }
-  if(--seccnt)
-    return;
-  seccnt = 3;     // every 3 seconds
 
-  rssi[rssiIdx] = WiFi.RSSI();
-  if(++rssiIdx >= RSSI_CNT) rssiIdx = 0;
+  if(nex.getPage()) // must be page 0
+    return;
 
   int16_t rssiAvg = 0;
   for(int i = 0; i < RSSI_CNT; i++)
     rssiAvg += rssi[i];
 
   rssiAvg /= RSSI_CNT;
-  if(rssiAvg == rssiT)
-    return;
 
-  nex.itemText(22, String(rssiT = rssiAvg) + "dB");
+  char sz[8];
+  sprintf(sz, "%ddB", rssiAvg);
+  if(!nex.itemText(22, sz)) // bars only change with the text
+    return;
 
-  int sigStrength = 127 + rssiT;
+  int sigStrength = 127 + rssiAvg;
   int wh = 24; // width and height
   int x = 178;
   int y = 172;
@@ -715,39 +911,25 @@ void Display::updateRSSI()
   }
 }
 
-void Display::updateRunIndicator(bool bForce) // run and fan running
+void Display::updateRunIndicator() // run and fan running
 {
   static bool bOn = false; // blinker
-  static bool bCurrent = false; // run indicator
-  static bool bPic = false; // red/blue
-  static bool bHumid = false; // next to rH
-
-  if(bForce)
-  {
-    bOn = false;
-    bCurrent = false;
-    bPic = false;
-    bHumid = false;
-  }
 
   if(hvac.getState()) // running
   {
-    if(bPic != (hvac.getState() > State_Cool) ? true:false)
-    {
-      bPic = (hvac.getState() > State_Cool) ? true:false;
-      nex.itemPic(4, bPic ? 3:1); // red or blue indicator
-    }
     if(hvac.m_bRemoteStream)
       bOn = !bOn; // blink indicator if remote temp
     else bOn = true; // just on
   }
   else bOn = false;
 
-  if(bCurrent != bOn && nex.getPage() == Page_Thermostat)
-    nex.visible("p4", (bCurrent = bOn) ? 1:0); // blinking run indicator
+  if(nex.getPage() != Page_Thermostat)
+    return;
 
-  if(bHumid != hvac.getHumidifierRunning() && nex.getPage() == Page_Thermostat)
-    nex.visible("p6", (bHumid = hvac.getHumidifierRunning()) ? 1:0); // blinking run indicator
+  if(hvac.getState())
+    nex.itemPic(4, (hvac.getState() > State_Cool) ? 3:1); // red or blue indicator
+  nex.visible("p4", bOn ? 1:0); // blinking run indicator
+  nex.visible("p6", hvac.getHumidifierRunning() ? 1:0); // humidifier running
 }
 
 // Lines demo
@@ -836,141 +1018,178 @@ void Display::addGraphPoints()
   p->bits.b.fan = hvac.getFanRunning();
   p->bits.b.state = hvac.getState(); 
   p->bits.b.res = 0; // just clear the extra
+
+#ifdef GRAPH_BUTTONS
+  // hourly summary
+  gSample *ph = &m_hours[m_hourIdx];
+  if(ph->time == 0xFFFFFFFF || ph->time / 3600 != p->time / 3600) // new hour
+  {
+    if(ph->time != 0xFFFFFFFF && ++m_hourIdx >= GHRS)
+      m_hourIdx = 0;
+    ph = &m_hours[m_hourIdx];
+    ph->tmin = ph->tmax = p->temp;
+  }
+  ph->time = p->time;
+  if(ph->tmin > p->temp) ph->tmin = p->temp;
+  if(ph->tmax < p->temp) ph->tmax = p->temp;
+  ph->temp = p->temp;
+  ph->l = p->l;
+  ph->h = p->h;
+  ph->bits = p->bits;
+#endif
+
   if(++m_pointsIdx >= GPTS)
     m_pointsIdx = 0;
 }
 
-// Draw the last 25 hours (todo: add run times)
+// Draw the history at the current zoom and pan (todo: add run times)
 void Display::fillGraph()
 {
+  static const uint16_t secsPerPx[] = {72, 300, 864, 2016}; // 6 hours, 25 hours (5 mins per pixel), 3 days, 1 week
+  static const uint32_t gridSecs[] = {3600, 6*3600, 12*3600, 24*3600};
+
   uint16_t textcolor = rgb16(0, 63, 31);
-  nex.text(292, 219, 2, textcolor, String(66));
+  nex.text(292, 219, 2, textcolor, "66");
   nex.line( 10, 164+8, 310, 164+8, rgb16(10, 20, 10) );
-  nex.text(292, 164, 2, textcolor, String(72));
+  nex.text(292, 164, 2, textcolor, "72");
   nex.line( 10, 112+8, 310, 112+8, rgb16(10, 20, 10) );
-  nex.text(292, 112, 2, textcolor, String(78));
+  nex.text(292, 112, 2, textcolor, "78");
   nex.line( 10,  58+8, 310,  58+8, rgb16(10, 20, 10) );
-  nex.text(292, 58, 2, textcolor, String(84));
-  nex.text(292,  8, 2, textcolor, String(90));
+  nex.text(292, 58, 2, textcolor, "84");
+  nex.text(292,  8, 2, textcolor, "90");
 
-  int x = 310 - (minute() / 5); // center over even hour, 5 mins per pixel
-  int h = hourFormat12();
+  uint16_t secs = secsPerPx[m_graphZoom];
+  uint32_t step = gridSecs[m_graphZoom];
+  int32_t tzOff = (ee.tz+hvac.m_DST)*3600;
+  uint32_t tEnd = now() - tzOff - (uint32_t)m_graphPan * secs * 150; // right edge, half a screen per pan
+  uint32_t lEnd = tEnd + tzOff; // local
+  char sz[4];
 
-  while(x > 10)
+  for(uint32_t g = lEnd - (lEnd % step); ; g -= step) // grid on even hours/days
   {
+    int x = 310 - (lEnd - g) / secs;
+    if(x <= 10)
+      break;
     nex.line(x, 10, x, 230, rgb16(10, 20, 10) );
-    nex.text(x-4, 0, 1, 0x7FF, String(h)); // draw hour above chart
-    x -= 12 * 6; // left 6 hours
-    h -= 6;
-    if( h <= 0) h += 12;
+    int h = (g / 3600) % 24;
+    if(step >= 12*3600 && h == 0)
+      nex.text(x-12, 0, 1, 0x7FF, _days_short[weekday(g)-1]); // day above chart
+    else
+    {
+      h %= 12;
+      if(h == 0) h = 12;
+      nex.text(x-4, 0, 1, 0x7FF, itoa(h, sz, 10)); // draw hour above chart
+    }
   }
-  drawPoints(0, rgb16( 22, 40, 10) ); // target (draw behind the other stuff)
-  drawPoints(1, rgb16( 22, 40, 10) ); // target threshold
-  drawPointsRh( rgb16(  0, 53,  0) ); // rh green
-//  if(hvac.isRemote())
-//  {
-//    drawPoints(2, rgb16( 31, 0,  15) ); // remote temp
-//  }
-  drawPointsTemp(); // off/cool/heat colors
+  drawGraph(tEnd, secs);
 }
 
-void Display::drawPoints(int w, uint16_t color)
+// Draw 300 columns ending at tEnd (UTC), secs per column
+// Each column is the min/max/last of the samples in it, so the cost only depends on the width
+// The samples go out from drawStep() as the queue has room
+void Display::drawGraph(uint32_t tEnd, uint16_t secs)
 {
-  int i = m_pointsIdx - 1;
-  if(i < 0) i = GPTS-1;
-  const int yOff = 240-10;
-  int y, y2;
-
-  switch(w)
-  {
-    case 0: y2 = m_points[i].h; break;
-    case 1: y2 = m_points[i].l; break;
-  }
-  if(y2 == -1) return; // not enough data
+  m_gd.tEnd = tEnd;
+  m_gd.tStart = tEnd - 300UL * secs;
+  m_gd.secs = secs;
+  m_gd.bHours = (now() - ((ee.tz+hvac.m_DST)*3600) - m_gd.tStart > GPTS * 300UL); // older than the 5 minute history
+  m_gd.n = 0;
+  m_gd.col = -1;
+  m_gd.bFirst = true;
+  m_drawJob = DJ_Graph;
+  drawStep();
+}
 
-  const int base = 660; // 66.0 base
-  y2 = (constrain(y2, 660, 900) - base) * 101 / 110;
+// Add the next sample (newest to oldest) to its column, false when the graph is done
+bool Display::graphSample()
+{
+  gSample s;
 
-  for(int x = 309, x2 = 310; x >= 10; x--)
+  if(getSample(m_gd.n++, m_gd.bHours, s) && s.time >= m_gd.tStart)
   {
-    if(--i < 0)
-      i = GPTS-1;
-
-    switch(w)
+    if(s.time > m_gd.tEnd)
+      return true;
+    int16_t x = 310 - (m_gd.tEnd - s.time) / m_gd.secs;
+    if(x != m_gd.col)
     {
-      case 0: y = m_points[i].h; break;
-      case 1: y = m_points[i].l; break;
+      if(m_gd.col >= 0)
+      {
+        graphColumn(m_gd.col, m_gd.c, m_gd.bFirst);
+        m_gd.bFirst = false;
+      }
+      m_gd.c = s; // newest in the column is the last value
+      m_gd.col = x;
     }
-
-    if(y == -1) return;
-    y = (constrain(y, 660, 900) - base) * 101 / 110; // 660~900 scale to 0~220
-
-    if(y != y2)
+    else
     {
-      nex.line(x, yOff - y, x2, yOff - y2, color);
-      delay(1);
-      y2 = y;
-      x2 = x;
+      if(m_gd.c.tmin > s.tmin) m_gd.c.tmin = s.tmin;
+      if(m_gd.c.tmax < s.tmax) m_gd.c.tmax = s.tmax;
     }
+    return true;
   }
+  if(m_gd.col < 0)
+    return false;
+  graphColumn(m_gd.col, m_gd.c, m_gd.bFirst);
+  for(uint8_t i = 0; i < 4; i++)
+    m_gLine[i].end();
+  return false;
 }
 
-void Display::drawPointsRh(uint16_t color)
+void Display::graphColumn(int16_t x, gSample &c, bool bFirst)
 {
-  int i = m_pointsIdx - 1;
-  if(i < 0) i = GPTS-1;
   const int yOff = 240-10;
-  int y, y2 = m_points[i].bits.b.rh;
-  if(y2 == -1) return; // not enough data
-
-  y2 = y2 * 55 / 250; // 0~100 to 0~240
+  const int base = 660; // 66.0 base
+  int16_t y[4];
 
-  for(int x = 309, x2 = 310; x >= 10; x--)
-  {
-    if(--i < 0)
-      i = GPTS-1;
+  y[0] = yOff - (constrain(c.h, 660, 900) - base) * 101 / 110; // 660~900 scale to 0~220
+  y[1] = yOff - (constrain(c.l, 660, 900) - base) * 101 / 110;
+  y[2] = yOff - c.bits.b.rh * 55 / 250; // 0~100 to 0~240
+  y[3] = yOff - (constrain(c.temp, 660, 900) - base) * 101 / 110;
 
-    y = m_points[i].bits.b.rh;
-    if(y == -1) return;
-    y = y * 55 / 250;
+  uint16_t color[4] = { rgb16( 22, 40, 10), rgb16( 22, 40, 10), rgb16(  0, 53,  0), stateColor(c.bits) }; // target, threshold, rh green, state
 
-    if(y != y2)
-    {
-      nex.line(x, yOff - y, x2, yOff - y2, color);
-      delay(1);
-      y2 = y;
-      x2 = x;
-    }
+  for(uint8_t i = 0; i < 4; i++)
+  {
+    if(bFirst)
+      m_gLine[i].start(x, y[i], color[i]);
+    else
+      m_gLine[i].add(x, y[i], color[i]);
   }
+
+  if(c.tmin != c.tmax) // range of temps in this column
+    nex.line(x, yOff - (constrain(c.tmax, 660, 900) - base) * 101 / 110, x, yOff - (constrain(c.tmin, 660, 900) - base) * 101 / 110, color[3]);
 }
 
-void Display::drawPointsTemp()
+// n = 0 for newest, from the 5 minute points or the hourly summaries
+bool Display::getSample(uint16_t n, bool bHours, gSample &s)
 {
-  const int yOff = 240-10;
-  int i = m_pointsIdx-1;
-  if(i < 0) i = GPTS-1;
-  uint8_t y, y2 = m_points[i].temp;
-  if(y2 == -1) return;
-  int x2 = 310;
-
-  const int base = 660; // 66.0 base
-  y2 = (constrain(y2, 660, 900) - base) * 101 / 110;
-
-  for(int x = 309; x >= 10; x--)
+  if(bHours)
   {
-    if(--i < 0)
-      i = GPTS-1;
-    y = m_points[i].temp;
-    if(y == -1) break; // invalid data
-    y = (constrain(y, 660, 900) - base) * 101 / 110;
-    if(y != y2)
-    {
-      nex.line(x2, yOff - y2, x, yOff - y, stateColor(m_points[i].bits) );
-      delay(1);
-      y2 = y;
-      x2 = x;
-    }
+#ifdef GRAPH_BUTTONS
+    if(n >= GHRS)
+      return false;
+    int idx = m_hourIdx - n;
+    if(idx < 0) idx += GHRS;
+    s = m_hours[idx];
+    return (s.time != 0xFFFFFFFF);
+#else
+    return false; // the 1 day view never needs them
+#endif
   }
+
+  if(n >= GPTS)
+    return false;
+  int idx = m_pointsIdx - 1 - n;
+  if(idx < 0) idx += GPTS;
+  gPoint *p = &m_points[idx];
+  if(p->temp == -1) // invalid data
+    return false;
+  s.time = p->time;
+  s.tmin = s.tmax = s.temp = p->temp;
+  s.l = p->l;
+  s.h = p->h;
+  s.bits = p->bits;
+  return true;
 }
 
 uint16_t Display::stateColor(gflags v) // return a color based on run state
@@ -996,6 +1215,54 @@ uint16_t Display::stateColor(gflags v) // return a color based on run state
   return color;
 }
 
+// forecast data (fetched or from the cache) isn't used up yet
+bool Display::fcValid()
+{
+  if(m_fcData[1].tm == 0)
+    return false;
+  fcStats();
+  return (m_fcData[m_fcCnt - 1].tm > now() - ((ee.tz+hvac.m_DST)*3600));
+}
+
+// Last complete forecast, so a restart or an outage doesn't leave the HVAC without one
+void Display::fcLoad()
+{
+  if(!SPIFFS.begin())
+    return;
+  File f = SPIFFS.open("/fc.dat", "r");
+  if(!f)
+    return;
+  if(f.size() == sizeof(m_fcData) + sizeof(m_fcCol)) // also rejects an old layout
+  {
+    f.read((uint8_t*)m_fcData, sizeof(m_fcData));
+    f.read((uint8_t*)m_fcCol, sizeof(m_fcCol));
+    m_bFcChanged = true;
+    m_bUpdateFcst = true; // still get a new one
+  }
+  f.close();
+}
+
+void Display::fcSave()
+{
+  File f = SPIFFS.open("/fc.dat", "w");
+  if(!f)
+    return;
+  f.write((uint8_t*)m_fcData, sizeof(m_fcData));
+  f.write((uint8_t*)m_fcCol, sizeof(m_fcCol));
+  f.close();
+}
+
+// value of an extra forecast series for the entry covering tm
+int8_t Display::fcValue(uint8_t col, uint32_t tm)
+{
+  if(col >= FC_COLS || m_fcData[1].tm == 0 || tm < m_fcData[1].tm)
+    return FC_NONE;
+
+  int i;
+  for(i = 1; i < FC_CNT - 1 && m_fcData[i+1].tm && tm >= m_fcData[i+1].tm; i++);
+  return m_fcCol[col][i];
+}
+
 bool Display::getGrapthPoints(gPoint *pts, int n)
 {
   if(n < 0 || n > GPTS-1) // convert 0-(GPTS-1) to reverse index circular buffer
@@ -1005,4 +1272,5 @@ bool Display::getGrapthPoints(gPoint *pts, int n)
   if(m_points[idx].temp == -1) // invalid data
     return false;
   memcpy(pts, &m_points[idx], sizeof(gPoint));
+  return true;
 }
@@ -2,11 +2,16 @@
 #define DISPLAY_H
 
 #include <Arduino.h>
+#include "PolyLine.h"
 
 #define NEX_TIMEOUT  90  // 90 seconds
 #define NEX_BRIGHT   95  // 100% = full brightness
 #define NEX_MEDIUM   25  // For the clock
 #define NEX_DIM       3  // for the lines, 1 = very dim, 0 = off
+#define CLOCK_PIC    13  // clock page picture in the HMI, full screen, used to crop out the second hand
+
+//#define GRAPH_BUTTONS  // uncomment once the graph page in Thermostat.HMI has zoom/pan buttons b1~b4
+                         // (adds 2.7K for a week of hourly history)
 
 struct Line{
   int16_t x1;
@@ -35,12 +40,41 @@ struct gPoint{
   gflags bits;
 };
 
+// graph history sample, also used for the hourly summary (min/max of the hour)
+struct gSample{
+  uint32_t time;
+  int16_t tmin;
+  int16_t tmax;
+  int16_t temp; // last
+  int16_t l;
+  int16_t h;
+  gflags bits;
+};
+
+#define FC_CNT 64
+#define FC_NONE -128 // no value for this time (nil in the forecast)
+
 struct Forecast
 {
   uint32_t tm;   // time
   int8_t temp;   // integer temperature value
 };
 
+enum FcCol // extra forecast series, a column each on the m_fcData time axis (only what the control logic uses)
+{
+  FC_DEW,   // dew point, for the humidifier
+  FC_COLS
+};
+
+enum DrawJob // drawing continued by drawStep()
+{
+  DJ_None,
+  DJ_Forecast,
+  DJ_Graph,
+};
+
+#define DRAW_ROOM 256 // queue bytes for one drawStep() point, a few lines and a text
+
 class Display
 {
 public:
@@ -56,37 +90,97 @@ public:
   void drawForecast(bool bRef);
   void Note(char *cNote);
   bool getGrapthPoints(gPoint *pt, int n);
+  int8_t fcValue(uint8_t col, uint32_t tm); // extra series value at a time, FC_NONE if none
+  bool fcValid(void);  // forecast still covers the current time
 private:
   void refreshAll(void);
-  void updateClock(void);
-  void cspoint(float &x2, float &y2, float x, float y, float angle, float size);
+  void updateClock(bool bRef);
+  void clockHand(uint16_t pos, uint8_t len, uint8_t spread, uint8_t base, uint16_t color, Line *pLines);
+  void clockPoint(int16_t &x, int16_t &y, uint16_t pos, int8_t size);
+  void secBox(Line &box, int8_t d1, int8_t d2);
+  bool lineHit(Line &box, Line &l);
   void displayTime(void);
   void displayOutTemp(void);
   void updateModes(void); // update any displayed settings
-  void updateAdjMode(bool bRef);  // current adjust indicator of the 4 temp settings
+  void updateAdjMode(void);  // current adjust indicator of the 4 temp settings
   void updateRSSI(void);
   void updateNotification(bool bRef);
-  void updateRunIndicator(bool bForce); // run and fan running
+  void updateRunIndicator(void); // run and fan running
   void addGraphPoints(void);
   void fillGraph(void);
-  void drawPoints(int w, uint16_t color);
-  void drawPointsRh(uint16_t color);
-  void drawPointsTemp(void);
+  void drawGraph(uint32_t tEnd, uint16_t secs);
+  bool graphSample(void);
+  bool fcPoint(void);
+  int  fcX(int i);
+  int  fcY(int i);
+  void drawStep(void);
+  void graphColumn(int16_t x, gSample &c, bool bFirst);
+  bool getSample(uint16_t n, bool bHours, gSample &s);
   uint16_t stateColor(gflags v);
   void Lines(void);
-  int tween(int8_t t1, int8_t t2, int m, int r);
+  void fcStats(void);
+  int  fcLerp(int i, int m);
+  void fcLoad(void);
+  void fcSave(void);
 
   uint16_t m_backlightTimer = NEX_TIMEOUT;
 #define GPTS 400 // 320 px width - (10+10) padding
   gPoint m_points[GPTS];
   uint16_t m_pointsIdx;
+#ifdef GRAPH_BUTTONS
+#define GHRS 168 // 1 week of hourly summaries for the zoomed out graph
+  gSample m_hours[GHRS];
+  uint8_t m_hourIdx; // current hour
+#endif
+  uint8_t m_graphZoom = 1; // 6h, 1d, 3d, 1w
+  uint8_t m_graphPan;      // half screens back from now
+  PolyLine m_gLine[4];     // target hi, lo, rh, temp
+  uint8_t  m_drawJob = DJ_None; // DrawJob still going
+  struct // graph drawing state
+  {
+    uint32_t tEnd;
+    uint32_t tStart;
+    uint16_t secs;
+    uint16_t n;      // next sample
+    int16_t  col;    // column being collected, -1 = none yet
+    gSample  c;
+    bool     bFirst;
+    bool     bHours;
+  } m_gd;
+  struct // forecast drawing state
+  {
+    int     i;       // next point
+    int     x2;
+    int     hOld;
+    int     day;
+    int     day_x;
+    int     hrs;
+    int8_t  tmin;
+    int8_t  tmax;
+    bool    bLine;   // grid done, drawing the line
+  } m_fd;
   uint16_t m_temp_counter = 2*60;
+  uint8_t  m_clockSec;  // hand positions drawn on the clock page
+  uint8_t  m_clockMin;
+  Line     m_handLine[4]; // minute and hour hand lines as drawn
 public:
-#define FC_CNT 64
+  PolyLine m_poly; // graph and forecast line merging
   Forecast m_fcData[FC_CNT];
+  int8_t   m_fcCol[FC_COLS][FC_CNT]; // see FcCol
   uint8_t  m_adjustMode; // which of 4 temps to adjust with rotary encoder
   bool     m_bUpdateFcst;
   bool     m_bUpdateFcstDone = true;
+  bool     m_bFcChanged;  // set when m_fcData is written
+  bool     m_bFcSave;     // set when a complete forecast was read, saved to flash next second
+private:
+  int8_t   m_fcCnt;       // length of m_fcData (40 max)
+  int8_t   m_fcRangeMin;  // min/max over ee.fcRange
+  int8_t   m_fcRangeMax;
+  int8_t   m_fcDispMin;   // min/max over ee.fcDisplay
+  int8_t   m_fcDispMax;
+  uint8_t  m_fcRangeN;    // ee values the min/max were made with
+  uint8_t  m_fcDispN;
+  uint8_t  m_fcNext = 1;  // first entry not past yet
 };
 
 #endif // DISPLAY_H
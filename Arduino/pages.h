@@ -204,7 +204,7 @@ const char page1[] PROGMEM =
    "\n"
    "function setVars()\n"
    "{\n"
-   " s='cmd;{\"key\":\"'+myToken+'\"'\n"
+   " s='batch;{\"key\":\"'+myToken+'\"'\n"
    " s+=',\"cooltemph\":'+(+a.coolh.value*10).toFixed()\n"
    " s+=',\"cooltempl\":'+(+a.cooll.value*10).toFixed()\n"
    " s+=',\"heattemph\":'+(+a.heath.value*10).toFixed()\n"
@@ -472,7 +472,7 @@ const char page2[] PROGMEM =
    "\n"
    "function setVars()\n"
    "{\n"
-   " s='cmd;{\"key\":\"'+a.myToken.value+'\"'\n"
+   " s='batch;{\"key\":\"'+a.myToken.value+'\"'\n"
    " s+=',\"cyclethresh\":'+(+a.thresh.value*10).toFixed()\n"
    " s+=',\"eheatthresh\":'+a.heatthr.value\n"
    " s+=',\"humidh\":'+(+a.humidh.value*10).toFixed()\n"
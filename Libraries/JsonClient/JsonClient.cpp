@@ -4,21 +4,32 @@
 
   This library is free software; you can redistribute it and/or modify it under the terms of the GNU GPL 2.1 or later.
 
-  Default 1024 byte limit for data received
+  Default 64 byte limit for an SSE event name, JSON is parsed as it arrives by JsonTokenizer
   8 lists max per instance
 */
 #include "JsonClient.h"
  
 #define TIMEOUT 30000 // Allow maximum 30s between data packets.
 
+enum JC_Line
+{
+  JL_Start,   // start of a line
+  JL_Prefix,  // "event", "data" or a header name, up to the :
+  JL_Event,   // SSE event name
+  JL_Data,    // JSON, fed to the tokenizer
+  JL_Skip,    // anything else, to the end of the line
+};
+
 // Initialize instance with a callback (event list index, name index from 0, integer value, string value)
 JsonClient::JsonClient(void (*callback)(int16_t iEvent, uint16_t iName, int iValue, char *psValue), uint16_t nSize )
+  : m_tok([](void *obj, const char *pPath, const char *pKey, char *pValue, uint8_t type) { (static_cast<JsonClient*>(obj))->token(pKey, pValue, type); }, this)
 {
   m_callback = callback;
   m_Status = JC_IDLE;
   m_jsonCnt = 0;
   m_bufcnt = 0;
   m_event = 0;
+  m_lineState = JL_Start;
   m_bKeepAlive = false;
   m_szHost[0] = 0;
   m_szPath[0] = 0;
@@ -73,19 +84,10 @@ bool JsonClient::begin(const char *pHost, const char *pPath, uint16_t port, bool
 
 void JsonClient::process(char *event, char *data)
 {
-  m_event = 0;
-
-  strcpy(m_pBuffer, "event:");
-  strcat(m_pBuffer, event);
-  strcat(m_pBuffer, "\r\n");
-  m_bufcnt = strlen(m_pBuffer);
-  processLine();
-
-  strcpy(m_pBuffer, "data:");
-  strcat(m_pBuffer, data);
-  strcat(m_pBuffer, "\r\n");
-  m_bufcnt = strlen(m_pBuffer);
-  processLine();
+  setEvent(event);
+  m_tok.begin();
+  m_tok.feed(data, strlen(data));
+  m_tok.end();
 }
 
 // Call this from loop() ->remove
@@ -159,11 +161,7 @@ void JsonClient::_onDisconnect(AsyncClient* client)
   if(m_bKeepAlive == false)
   {
     m_Status = JC_DONE;
-    if(m_bufcnt) // no LF at end?
-    {
-        m_pBuffer[m_bufcnt] = '\0';
-        processLine();
-    }
+    lineByte('\n'); // no LF at end?
 	m_callback(-1, m_Status, m_nPort, m_szHost);
     return;
   }
@@ -213,7 +211,8 @@ void JsonClient::_onConnect(AsyncClient* client)
   }
 
   m_Status = JC_CONNECTED;
-  m_brace = 0;
+  m_lineState = JL_Start;
+  m_tok.begin();
   m_callback(-1, m_Status, m_nPort, m_szHost);
 }
 
@@ -224,89 +223,110 @@ void JsonClient::_onData(AsyncClient* client, char* data, size_t len)
 	return;
 
   for(int i = 0; i < len; i++)
-  {
-    char c = data[i];
-    if(c != '\r' && m_bufcnt < m_nBufSize)
-      m_pBuffer[m_bufcnt++] = c;
-    if(c == '\n')
-    {
-      if(m_bufcnt > 1) // ignore keepalive
-      {
-        m_pBuffer[m_bufcnt-1] = '\0';
-        processLine();
-      }
-      m_bufcnt = 0;
-    }
-  }
+    lineByte(data[i]);
   m_timeOut = millis();
 }
 
-void JsonClient::processLine()
+// Sorts the stream into SSE "event:" names, JSON (after "data:" or at the start of a line) and headers to skip
+void JsonClient::lineByte(char c)
 {
-  if(m_jsonCnt == 0)
+  if(c == '\r')
     return;
 
-  char *pPair[2]; // param:data pair
-
-  char *p = m_pBuffer;
-
-  while(*p)
+  switch(m_lineState)
   {
-    p = skipwhite(p);
-    if(*p == '{'){p++; m_brace++;}
-    if(*p == ',') p++;
-    p = skipwhite(p);
-
-    bool bInQ = false;
-    if(*p == '"'){p++; bInQ = true;}
-    pPair[0] = p;
-    if(bInQ)
-    {
-       while(*p && *p!= '"') p++;
-       if(*p == '"') *p++ = 0;
-    }else
-    {
-      while(*p && *p != ':') p++;
-    }
-    if(*p != ':') return;
-    *p++ = 0;
-    p = skipwhite(p);
-    if(*p == '{'){p++; m_brace++; continue;} // data: {
-
-    bInQ = false;
-    if(*p == '"'){p++; bInQ = true;}
-    pPair[1] = p;
-    if(bInQ)
-    {
-       while(*p && *p!= '"') p++;
-       if(*p == '"') *p++ = 0;
-    }else
-    {
-      while(*p && *p != ',' && *p != '}' && *p != '\r' && *p != '\n') p++;
-      if(*p == '}') m_brace--;
-      *p++ = 0;
-    }
-    p = skipwhite(p);
-    if(*p == '}'){*p++ = 0; m_brace--;}
-
-    if(pPair[0][0])
-    {
-      if(!strcmp(pPair[0], "event") && m_jsonList[0][0]) // need event names
+    case JL_Start:
+      m_bufcnt = 0;
+      if(c == '\n' && m_tok.depth() == 0)   // blank line or keepalive
+        break;
+      if(m_tok.depth() == 0 && c != '{' && c != '[')
       {
-        for(int i = 0; i < m_jsonCnt; i++)
-          if(!strcmp(pPair[1], m_jsonList[i][0]))
-            m_event = i;
+        m_pBuffer[m_bufcnt++] = c;
+        m_lineState = JL_Prefix;
+        break;
       }
-      else for(int i = 1; m_jsonList[m_event][i]; i++)
+      if(m_tok.depth() == 0)                // new JSON document
+        m_tok.begin();
+      m_lineState = JL_Data;
+      m_tok.feed(c);
+      break;
+    case JL_Prefix:
+      if(c == ':')
       {
-        if(!strcmp(pPair[0], m_jsonList[m_event][i]))
+        m_pBuffer[m_bufcnt] = 0;
+        m_bufcnt = 0;
+        if(!strcmp(m_pBuffer, "event"))
+          m_lineState = JL_Event;
+        else if(!strcmp(m_pBuffer, "data"))
         {
-            int n = atoi(pPair[1]);
-            if(!strcmp(pPair[1], "true")) n = 1; // bool case
-            m_callback(m_event, i-1, n, pPair[1]);
-            break;
+          m_tok.begin();
+          m_lineState = JL_Data;
         }
+        else
+          m_lineState = JL_Skip;
+      }
+      else if(c == '\n')                    // status line or chunk size
+        m_lineState = JL_Start;
+      else if(m_bufcnt < m_nBufSize - 1)
+        m_pBuffer[m_bufcnt++] = c;
+      break;
+    case JL_Event:
+      if(c == '\n')
+      {
+        m_pBuffer[m_bufcnt] = 0;
+        setEvent(skipwhite(m_pBuffer));
+        m_lineState = JL_Start;
+      }
+      else if(m_bufcnt < m_nBufSize - 1)
+        m_pBuffer[m_bufcnt++] = c;
+      break;
+    case JL_Data:
+      m_tok.feed(c);
+      if(c == '\n')
+      {
+        if(m_tok.depth() == 0)              // done, or a plain "data: text" line
+          m_tok.end();
+        m_lineState = JL_Start;
       }
+      break;
+    case JL_Skip:
+      if(c == '\n')
+        m_lineState = JL_Start;
+      break;
+  }
+}
+
+// select the list for following data
+void JsonClient::setEvent(const char *pName)
+{
+  if(m_jsonCnt == 0 || m_jsonList[0][0] == NULL || m_jsonList[0][0][0] == 0) // no event names
+    return;
+  for(int i = 0; i < m_jsonCnt; i++)
+    if(!strcmp(pName, m_jsonList[i][0]))
+      m_event = i;
+}
+
+void JsonClient::token(const char *pKey, char *pValue, uint8_t type)
+{
+  if(m_jsonCnt == 0)
+    return;
+  if(pKey[0] == 0)           // a non-JSON "data:" line
+    pKey = "data";
+
+  if(!strcmp(pKey, "event") && m_jsonList[0][0] && m_jsonList[0][0][0]) // {"event":"name"} selects the list too
+  {
+    setEvent(pValue);
+    return;
+  }
+
+  for(int i = 1; m_jsonList[m_event][i]; i++)
+  {
+    if(!strcmp(pKey, m_jsonList[m_event][i]))
+    {
+        int n = atoi(pValue);
+        if(!strcmp(pValue, "true")) n = 1; // bool case
+        m_callback(m_event, i-1, n, pValue);
+        break;
     }
   }
 }
@@ -9,6 +9,7 @@
 
 #include <Arduino.h>
 #include <ESPAsyncTCP.h>
+#include <JsonTokenizer.h>
 
 enum JC_Status
 {
@@ -26,7 +27,7 @@ enum JC_Status
 class JsonClient
 {
 public:
-  JsonClient(void (*callback)(int16_t iEvent, uint16_t iName, int iValue, char *psValue), uint16_t nSize = 1024);
+  JsonClient(void (*callback)(int16_t iEvent, uint16_t iName, int iValue, char *psValue), uint16_t nSize = 64);
   bool  addList(const char **pList);
   bool  begin(const char *pHost, const char *pPath, uint16_t port, bool bKeepAlive, bool bPost = false, const char **pHeaders = NULL, char *pData = NULL);
   bool  service(void);
@@ -36,13 +37,16 @@ public:
 
 private:
   bool  connect(void);
-  void  processLine(void);
+  void  lineByte(char c);
+  void  setEvent(const char *pName);
+  void  token(const char *pKey, char *pValue, uint8_t type);
   void  sendHeader(const char *pHeaderName, const char *pHeaderValue);
   void  sendHeader(const char *pHeaderName, int nHeaderValue);
   void  (*m_callback)(int16_t iEvent, uint16_t iName, int iValue, char *psValue);
   char *skipwhite(char *p);
 
   AsyncClient m_ac;
+  JsonTokenizer m_tok;
   void _onConnect(AsyncClient* client);
   void _onDisconnect(AsyncClient* client);
   static void _onError(AsyncClient* client, int8_t error);
@@ -60,9 +64,9 @@ private:
   uint16_t m_event;
   uint16_t m_nPort;
   uint16_t m_nBufSize;
-  char     *m_pBuffer;
+  char     *m_pBuffer;     // SSE event name or line prefix
   unsigned long m_timeOut;
-  int16_t m_brace;
+  uint8_t m_lineState;
   int16_t m_retryCnt;
   uint8_t m_jsonCnt;
   int8_t  m_Status;
@@ -1,102 +1,99 @@
 /*
-  JsonParse.h - Arduino library for parsing JSON data.  Note: Data string is written to for NULL termination.
+  JsonParse.h - Arduino library for parsing JSON data.
   Copyright 2016 Greg Cunningham, CuriousTech.net
 
   This library is free software; you can redistribute it and/or modify it under the terms of the GNU GPL 2.1 or later.
 
-  8 lists max per instance
+  8 lists max per instance.  Parsing is done by JsonTokenizer
 */
 #include "JsonParse.h"
  
 // Initialize instance with a callback (event list index, name index from 0, integer value, string value)
 JsonParse::JsonParse(void (*callback)(int16_t iEvent, uint16_t iName, int iValue, char *psValue) )
+  : m_tok([](void *obj, const char *pPath, const char *pKey, char *pValue, uint8_t type) { (static_cast<JsonParse*>(obj))->token(pKey, pValue, type); }, this)
 {
   m_callback = callback;
   m_jsonCnt = 0;
+  m_slotCnt = 0;
+  memset(m_slot, 0, sizeof(m_slot));
 }
 
 // add a json list {"event name", "valname1", "valname2", "valname3", NULL}
+// Names are hashed here so each key is found with one or two compares
 bool JsonParse::addList(const char **pList)
 {
-  if(m_jsonCnt >= 8)
+  if(m_jsonCnt >= JP_LISTS)
     return false;
+
+  uint8_t n = 0;
+  while(pList[n + 1]) n++;
+  if(m_slotCnt + n > JP_SLOTS * 3 / 4) // keep the table under 3/4 full
+    return false;
+
+  for(int i = 1; pList[i]; i++)
+  {
+    uint16_t h = hash(pList[i], m_jsonCnt);
+    while(m_slot[h])
+      h = (h + 1) & (JP_SLOTS - 1);
+    m_slot[h] = ((m_jsonCnt << 8) | i) + 1;
+  }
+  m_slotCnt += n;
   m_jsonList[m_jsonCnt++] = pList;
   return true;
 }
 
-void JsonParse::process(char *event, char *data)
+// FNV-1a of the name, mixed with the list so each list has its own entries
+uint16_t JsonParse::hash(const char *p, uint8_t list)
+{
+  uint32_t h = 2166136261UL ^ list;
+  while(*p)
+  {
+    h ^= (uint8_t)*p++;
+    h *= 16777619UL;
+  }
+  return (h ^ (h >> 16)) & (JP_SLOTS - 1);
+}
+
+// Keys are matched at any depth, so {"a":{"temp":1}} gives temp like {"temp":1}
+// Returns false if the data isn't complete, valid JSON (values before the error were still given)
+bool JsonParse::process(char *event, char *data)
 {
+  m_unknown = 0;
   if(m_jsonCnt == 0)
-    return;
+    return false;
 
-  uint16_t _event = 0;
+  m_event = 0;
   for(int i = 0; i < m_jsonCnt; i++)
     if(!strcmp(event, m_jsonList[i][0]))
-      _event = i;
-
-  char *pPair[2]; // param:data pair
-
-  char *p = data;
-  int16_t brace = 0;
-
-  while(*p)
-  {
-    p = skipwhite(p);
-    if(*p == '{'){p++; brace++;}
-    if(*p == ',') p++;
-    p = skipwhite(p);
-
-    bool bInQ = false;
-    if(*p == '"'){p++; bInQ = true;}
-    pPair[0] = p;
-    if(bInQ)
-    {
-       while(*p && *p!= '"') p++;
-       if(*p == '"') *p++ = 0;
-    }else
     {
-      while(*p && *p != ':') p++;
+      m_event = i;
+      break;
     }
-    if(*p != ':') return;
-    *p++ = 0;
-    p = skipwhite(p);
-    if(*p == '{'){p++; brace++; continue;} // data: {
 
-    bInQ = false;
-    if(*p == '"'){p++; bInQ = true;}
-    pPair[1] = p;
-    if(bInQ)
-    {
-       while(*p && *p!= '"') p++;
-       if(*p == '"') *p++ = 0;
-    }else
-    {
-      while(*p && *p != ',' && *p != '}' && *p != '\r' && *p != '\n') p++;
-      if(*p == '}') brace--;
-      *p++ = 0;
-    }
-    p = skipwhite(p);
-    if(*p == '}'){*p++ = 0; brace--;}
+  uint16_t errors = m_tok.m_errors;
+  m_tok.begin();
+  m_tok.feed(data, strlen(data));
+  bool bComplete = (m_tok.depth() == 0); // not cut off
+  m_tok.end();
+  return (bComplete && m_tok.m_errors == errors);
+}
 
-    if(pPair[0][0])
+void JsonParse::token(const char *pKey, char *pValue, uint8_t type)
+{
+  if(pKey[0] == 0)
+    return;
+
+  for(uint16_t h = hash(pKey, m_event); m_slot[h]; h = (h + 1) & (JP_SLOTS - 1))
+  {
+    uint8_t list = (m_slot[h] - 1) >> 8;
+    uint8_t i = (m_slot[h] - 1) & 0xFF;
+    if(list == m_event && !strcmp(pKey, m_jsonList[list][i]))
     {
-      for(int i = 1; m_jsonList[_event][i]; i++)
-      {
-        if(!strcmp(pPair[0], m_jsonList[_event][i]))
-        {
-            int n = atoi(pPair[1]);
-            if(!strcmp(pPair[1], "true")) n = 1; // bool case
-            m_callback(_event, i-1, n, pPair[1]);
-            break;
-        }
-      }
+      int n = atoi(pValue);
+      if(!strcmp(pValue, "true")) n = 1; // bool case
+      m_callback(m_event, i-1, n, pValue);
+      return;
     }
   }
-}
-
-char * JsonParse::skipwhite(char *p)
-{
-  while(*p == ' ' || *p == '\t' || *p =='\r' || *p == '\n')
-    p++;
-  return p;
+  m_unknown++;
 }
@@ -8,21 +8,29 @@
 #define JSONPARSE_H
 
 #include <Arduino.h>
+#include <JsonTokenizer.h>
 
 class JsonParse
 {
 public:
   JsonParse(void (*callback)(int16_t iEvent, uint16_t iName, int iValue, char *psValue));
   bool  addList(const char **pList);
-  void  process(char *event, char *data);
+  bool  process(char *event, char *data);
+  uint16_t m_unknown; // keys not in the list in the last process()
 
 private:
-  char *skipwhite(char *p);
+  void  token(const char *pKey, char *pValue, uint8_t type);
+  uint16_t hash(const char *p, uint8_t list);
   void  (*m_callback)(int16_t iEvent, uint16_t iName, int iValue, char *psValue);
 
-#define LIST_CNT
-  const char **m_jsonList[8];
+  JsonTokenizer m_tok;
+#define JP_LISTS 8 // name lists
+  const char **m_jsonList[JP_LISTS];
+#define JP_SLOTS 128 // hash table for all names of all lists, must be a power of 2
+  uint16_t m_slot[JP_SLOTS]; // (list << 8 | name index) + 1, 0 = empty
+  uint8_t m_slotCnt;
   uint8_t m_jsonCnt;
+  uint16_t m_event;
 };
 
 #endif // JSONPARSE_H
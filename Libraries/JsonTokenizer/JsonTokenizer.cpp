@@ -0,0 +1,357 @@
+/*
+  JsonTokenizer.cpp - Arduino library for reading JSON a byte at a time (SAX style).
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU GPL 2.1 or later.
+
+  Nothing is buffered but the current path, key and value, so input can come in any size pieces.
+  Nested objects and arrays up to JT_DEPTH, escapes including \uXXXX (as UTF-8).
+*/
+#include "JsonTokenizer.h"
+
+enum JT_State
+{
+  JS_Value,     // expecting a value
+  JS_Key,       // expecting a key or }
+  JS_Colon,     // after a key
+  JS_After,     // after a value, expecting , } or ]
+  JS_String,
+  JS_Escape,
+  JS_Unicode,
+  JS_Literal,   // number, true, false, null (or unquoted text)
+  JS_BareKey,   // unquoted key, as in {sum:0}
+};
+
+JsonTokenizer::JsonTokenizer(void (*callback)(void *obj, const char *pPath, const char *pKey, char *pValue, uint8_t type), void *obj)
+{
+  m_callback = callback;
+  m_obj = obj;
+  m_errors = 0;
+  begin();
+}
+
+void JsonTokenizer::begin()
+{
+  m_state = JS_Value;
+  m_depth = 0;
+  m_arr = 0;
+  m_pathLen = 0;
+  m_path[0] = 0;
+  m_valLen = 0;
+  m_bKey = false;
+}
+
+uint8_t JsonTokenizer::depth()
+{
+  return m_depth;
+}
+
+void JsonTokenizer::feed(const char *p, size_t len)
+{
+  while(len)
+  {
+    if(m_state == JS_String)                // copy plain string text in one go
+    {
+      size_t n = 0;
+      while(n < len && p[n] != '"' && p[n] != '\\')
+        n++;
+      size_t cp = min(n, (size_t)(JT_VALUE - m_valLen));
+      memcpy(m_val + m_valLen, p, cp);
+      m_valLen += cp;
+      p += n;
+      len -= n;
+      if(len == 0)
+        break;
+    }
+    feed(*p++);
+    len--;
+  }
+}
+
+void JsonTokenizer::feed(char c)
+{
+  switch(m_state)
+  {
+    case JS_String:
+      if(c == '"')
+      {
+        m_val[m_valLen] = 0;
+        if(m_bKey)
+        {
+          keyDone();
+          m_state = JS_Colon;
+        }
+        else
+        {
+          emit(JT_STRING);
+          m_state = JS_After;
+        }
+      }
+      else if(c == '\\')
+        m_state = JS_Escape;
+      else
+        addVal(c);
+      break;
+    case JS_Escape:
+      m_state = JS_String;
+      switch(c)
+      {
+        case 'b': addVal('\b'); break;
+        case 'f': addVal('\f'); break;
+        case 'n': addVal('\n'); break;
+        case 'r': addVal('\r'); break;
+        case 't': addVal('\t'); break;
+        case 'u': m_state = JS_Unicode; m_uni = 0; m_uniCnt = 0; break;
+        default:  addVal(c); break;   // \" \\ \/
+      }
+      break;
+    case JS_Unicode:
+      if(!isxdigit(c))
+      {
+        error();
+        break;
+      }
+      m_uni = (m_uni << 4) | (isdigit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+      if(++m_uniCnt < 4)
+        break;
+      if(m_uni < 0x80)                      // as UTF-8
+        addVal(m_uni);
+      else if(m_uni < 0x800)
+      {
+        addVal(0xC0 | (m_uni >> 6));
+        addVal(0x80 | (m_uni & 0x3F));
+      }
+      else
+      {
+        addVal(0xE0 | (m_uni >> 12));
+        addVal(0x80 | ((m_uni >> 6) & 0x3F));
+        addVal(0x80 | (m_uni & 0x3F));
+      }
+      m_state = JS_String;
+      break;
+    case JS_BareKey:
+      if(c == ':')
+      {
+        while(m_valLen && m_val[m_valLen - 1] == ' ') m_valLen--;
+        m_val[m_valLen] = 0;
+        keyDone();
+        m_state = JS_Value;
+      }
+      else if(c == ',' || c == '{' || c == '}' || c == '[' || c == ']' || c == '"')
+        error();
+      else
+        addVal(c);
+      break;
+    case JS_Literal:
+      if(c == ',' || c == '}' || c == ']' || c == '\r' || c == '\n')
+      {
+        while(m_valLen && (m_val[m_valLen - 1] == ' ' || m_val[m_valLen - 1] == '\t')) m_valLen--;
+        m_val[m_valLen] = 0;
+        uint8_t type = JT_LITERAL;
+        if(!strcmp(m_val, "true")) type = JT_TRUE;
+        else if(!strcmp(m_val, "false")) type = JT_FALSE;
+        else if(!strcmp(m_val, "null")) type = JT_NULL;
+        else if(isdigit(m_val[0]) || (m_val[0] == '-' && isdigit(m_val[1]))) type = JT_NUMBER;
+        emit(type);
+        m_state = JS_After;
+        feed(c);                            // the delimiter
+      }
+      else
+        addVal(c);
+      break;
+    default:
+      if(c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        break;
+      switch(m_state)
+      {
+        case JS_Value:
+          value(c);
+          break;
+        case JS_Key:
+          if(c == '"')
+          {
+            m_bKey = true;
+            m_valLen = 0;
+            m_state = JS_String;
+          }
+          else if(c == '}')
+            pop(c);
+          else if(c == ',' || c == ':' || c == '{' || c == '[' || c == ']')
+            error();
+          else                              // lenient: unquoted key
+          {
+            m_valLen = 0;
+            addVal(c);
+            m_state = JS_BareKey;
+          }
+          break;
+        case JS_Colon:
+          if(c == ':')
+            m_state = JS_Value;
+          else
+            error();
+          break;
+        case JS_After:
+          if(m_depth == 0)                  // next top level value
+          {
+            m_state = JS_Value;
+            value(c);
+          }
+          else if(c == ',')
+          {
+            if(m_arr & (1 << (m_depth - 1)))
+            {
+              m_idx[m_depth - 1]++;
+              m_state = JS_Value;
+            }
+            else
+              m_state = JS_Key;
+          }
+          else if(c == '}' || c == ']')
+            pop(c);
+          else
+            error();
+          break;
+      }
+      break;
+  }
+}
+
+// first character of a value
+void JsonTokenizer::value(char c)
+{
+  if(m_depth && (m_arr & (1 << (m_depth - 1))))
+  {
+    if(c == ']' && m_idx[m_depth - 1] == 0) // empty array
+    {
+      pop(c);
+      return;
+    }
+    setPath();
+  }
+
+  m_valLen = 0;
+  switch(c)
+  {
+    case '{':
+      push(false);
+      m_state = JS_Key;
+      break;
+    case '[':
+      push(true);
+      m_state = JS_Value;
+      break;
+    case '"':
+      m_state = JS_String;
+      break;
+    case ',':
+    case ':':
+    case '}':
+    case ']':
+      error();
+      break;
+    default:
+      addVal(c);
+      m_state = JS_Literal;
+      break;
+  }
+}
+
+// key in m_val replaces the last key in the path
+void JsonTokenizer::keyDone()
+{
+  m_bKey = false;
+  m_pathLen = m_seg[m_depth - 1];
+  if(m_pathLen && m_pathLen < JT_PATH) m_path[m_pathLen++] = '.';
+  for(char *p = m_val; *p && m_pathLen < JT_PATH; p++)
+    m_path[m_pathLen++] = *p;
+  m_path[m_pathLen] = 0;
+}
+
+// path of an array element: container path + [n]
+void JsonTokenizer::setPath()
+{
+  char sz[6];
+  uint8_t n = m_idx[m_depth - 1];
+  int i = sizeof(sz) - 1;
+
+  sz[i] = 0;
+  sz[--i] = ']';
+  do{
+    sz[--i] = '0' + (n % 10);
+    n /= 10;
+  }while(n);
+  sz[--i] = '[';
+
+  m_pathLen = m_seg[m_depth - 1];
+  for(char *p = sz + i; *p && m_pathLen < JT_PATH; p++)
+    m_path[m_pathLen++] = *p;
+  m_path[m_pathLen] = 0;
+}
+
+void JsonTokenizer::push(bool bArray)
+{
+  if(m_depth >= JT_DEPTH)
+  {
+    error();
+    return;
+  }
+  m_seg[m_depth] = m_pathLen;
+  m_idx[m_depth] = 0;
+  if(bArray)
+    m_arr |= (1 << m_depth);
+  else
+    m_arr &= ~(1 << m_depth);
+  m_depth++;
+}
+
+void JsonTokenizer::pop(char c)
+{
+  bool bArray = (m_arr & (1 << (m_depth - 1)));
+  if(bArray != (c == ']'))
+  {
+    error();
+    return;
+  }
+  m_depth--;
+  m_pathLen = m_seg[m_depth];
+  m_path[m_pathLen] = 0;
+  m_state = JS_After;
+}
+
+void JsonTokenizer::emit(uint8_t type)
+{
+  // key is the last path segment without any [n]
+  int e = m_pathLen;
+  while(e && m_path[e - 1] == ']')
+  {
+    while(e && m_path[e - 1] != '[') e--;
+    if(e) e--;
+  }
+  int s = e;
+  while(s && m_path[s - 1] != '.') s--;
+  if(e - s > JT_KEY) e = s + JT_KEY;
+  memcpy(m_key, m_path + s, e - s);
+  m_key[e - s] = 0;
+
+  m_callback(m_obj, m_path, m_key, m_val, type);
+}
+
+void JsonTokenizer::addVal(char c)
+{
+  if(m_valLen < JT_VALUE)
+    m_val[m_valLen++] = c;
+}
+
+void JsonTokenizer::error()
+{
+  m_errors++;
+  begin();
+}
+
+// input ended, a top level number or word has no delimiter after it
+void JsonTokenizer::end()
+{
+  if(m_state == JS_Literal && m_depth == 0)
+    feed('\n');
+  begin();
+}
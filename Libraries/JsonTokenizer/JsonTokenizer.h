@@ -0,0 +1,66 @@
+/*
+  JsonTokenizer.h - Arduino library for reading JSON a byte at a time (SAX style).
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU GPL 2.1 or later.
+*/
+#ifndef JSONTOKENIZER_H
+#define JSONTOKENIZER_H
+
+#include <Arduino.h>
+
+enum JT_Type
+{
+  JT_STRING,
+  JT_NUMBER,
+  JT_TRUE,
+  JT_FALSE,
+  JT_NULL,
+  JT_LITERAL, // unquoted, not a number or keyword
+};
+
+#define JT_DEPTH    8  // deepest nesting
+#define JT_PATH    64  // "key.key[n].key" of the current value, longer is cut
+#define JT_KEY     32
+#define JT_VALUE  128  // longest value, longer is cut
+
+class JsonTokenizer
+{
+public:
+  // callback gets the path ("a.b[2].c"), innermost object key ("c", or the array's key for its elements),
+  // the value text and its JT_Type, for every scalar value
+  JsonTokenizer(void (*callback)(void *obj, const char *pPath, const char *pKey, char *pValue, uint8_t type), void *obj);
+  void    begin(void);                     // start over, drops anything partial
+  void    feed(char c);                    // next byte, may be split anywhere between calls
+  void    feed(const char *p, size_t len);
+  void    end(void);                       // end of input, finishes a top level value
+  uint8_t depth(void);                     // 0 = not in an object or array
+  uint16_t m_errors;                       // syntax errors (parser starts over at each)
+
+private:
+  void  value(char c);
+  void  push(bool bArray);
+  void  pop(char c);
+  void  emit(uint8_t type);
+  void  setPath(void);
+  void  keyDone(void);
+  void  error(void);
+  void  addVal(char c);
+
+  void  (*m_callback)(void *obj, const char *pPath, const char *pKey, char *pValue, uint8_t type);
+  void  *m_obj;
+  char    m_path[JT_PATH + 1];
+  char    m_key[JT_KEY + 1];
+  char    m_val[JT_VALUE + 1];
+  uint8_t m_seg[JT_DEPTH];    // path length of each container
+  uint8_t m_idx[JT_DEPTH];    // array element index
+  uint8_t m_arr;              // bit per depth, set = array
+  uint8_t m_depth;
+  uint8_t m_pathLen;
+  uint8_t m_valLen;
+  uint8_t m_state;
+  bool    m_bKey;             // string being read is a key
+  uint16_t m_uni;             // \uXXXX value
+  uint8_t m_uniCnt;
+};
+
+#endif // JSONTOKENIZER_H
@@ -27,19 +27,52 @@
 #include "SHT21.h"
 #include "Arduino.h"
 
+#define SHT21_DELTA 40 // about 0.2F in raw units, change per reading that keeps the fast rate
+#define SHT21_RETRIES 2
+
 /**********************************************************
  * Initialize the sensor based on the specified type.
  **********************************************************/
 SHT21::SHT21(uint8_t sda, uint8_t sdc, uint8_t seconds) {
   m_sda = sda;
   m_sdc = sdc;
-  m_interval = seconds * 10;
+  m_fast = m_slow = m_interval = seconds * 1000UL;
+  m_res = SHT21_RH12_T14;
+  m_bSetRes = false;
+  m_bActive = false;
+  m_state = 0;
+  m_lastTemp = 0;
+  memset(&m_stats, 0, sizeof(m_stats));
 }
 
 void SHT21::init() {
   Wire.begin(m_sda, m_sdc);
   Wire.setClock(400000);
-  m_mil = millis();
+  if(m_bSetRes)
+    writeResolution();
+  m_mil = millis() - m_interval; // start first reading now
+}
+
+// Set resolution, applied before the next reading
+void SHT21::setResolution(uint8_t res)
+{
+  m_res = res & 0x81;
+  m_bSetRes = true;
+}
+
+// Read faster when active or the temperature is changing, back off to slow at steady state
+void SHT21::setInterval(uint8_t fastSeconds, uint8_t slowSeconds)
+{
+  m_fast = fastSeconds * 1000UL;
+  m_slow = max(fastSeconds, slowSeconds) * 1000UL;
+  m_interval = m_fast;
+}
+
+void SHT21::setActive(bool bActive)
+{
+  m_bActive = bActive;
+  if(bActive)
+    m_interval = m_fast;
 }
 
 /**********************************************************
@@ -56,51 +89,148 @@ void SHT21::init() {
  *        125°C.)
  *      8 bit 1 3 ms
  *
+ *   RH: 12 bit 29ms, 11 bit 15ms, 10 bit 9ms, 8 bit 4ms (max)
  **********************************************************/
 
-bool SHT21::service()
+static uint8_t convTime(uint8_t res, bool bTemp)
 {
-  static uint8_t state = 0;
-  bool bRc = false;
+  switch(res)
+  {
+    case SHT21_RH8_T12:  return bTemp ? 22 : 4;
+    case SHT21_RH10_T13: return bTemp ? 43 : 9;
+    case SHT21_RH11_T11: return bTemp ? 11 : 15;
+  }
+  return bTemp ? 85 : 29; // RH12_T14
+}
 
-  if(millis() - m_mil < 100)
-    return false;
+// Non-blocking: start temp, wait, read, start rh, wait, read, then idle until the next interval
+bool SHT21::service()
+{
+  uint16_t val;
 
-  switch(state)
+  switch(m_state)
   {
-    case 0:
-      Wire.beginTransmission(eSHT21Address);   //begin
-      Wire.write(eTempNoHoldCmd);              //send the pointer location
-      Wire.endTransmission();                  //end
-      break;
-    case 1: // 100ms later...
-      Wire.requestFrom(eSHT21Address, 3);
-      break;
-    case 2: // 100ms later...
-      if(Wire.available() < 3) return false; // not ready
-      m_temp = ( Wire.read() << 8 ) | ( Wire.read() & 0xFFFC );
+    case 0: // idle
+      if(millis() - m_mil < m_interval)
+        return false;
+      m_mil = millis();
+      if(m_bSetRes)
+        writeResolution();
+      m_retry = 0;
+      startMeasurement(eTempNoHoldCmd);
+      m_state = 1;
       break;
-    case 3:
-      break;
-    case 4:
-      Wire.beginTransmission(eSHT21Address);   //begin
-      Wire.write(eRHumidityNoHoldCmd);         //send the pointer location
-      Wire.endTransmission();                  //end
-      break;
-    case 5:
-      Wire.requestFrom(eSHT21Address, 3);
-      break;
-    case 6:
-      if(Wire.available() < 3) return false; // not ready
-      m_rh = ( Wire.read() << 8 ) | ( Wire.read() & 0xFFFC );
-      bRc = true;
+    case 1: // temperature conversion
+      if(millis() - m_cmdMil < convTime(m_res, true))
+        return false;
+      if(!readValue(val))
+        return false;
+      m_temp = val;
+      m_retry = 0;
+      startMeasurement(eRHumidityNoHoldCmd);
+      m_state = 2;
       break;
+    case 2: // humidity conversion
+      if(millis() - m_cmdMil < convTime(m_res, false))
+        return false;
+      if(!readValue(val))
+        return false;
+      m_rh = val;
+      m_stats.reads++;
+      m_state = 0;
+      nextInterval();
+      return true;
   }
+  return false;
+}
 
-  if(++state > m_interval)
-    state = 0;
-  m_mil = millis();
-  return bRc;
+void SHT21::startMeasurement(uint8_t cmd)
+{
+  Wire.beginTransmission(eSHT21Address);   //begin
+  Wire.write(cmd);                         //send the pointer location
+  Wire.endTransmission();                  //end
+  m_cmdMil = millis();
+}
+
+// Read 2 data bytes + CRC.  False if not ready, or restarts/aborts the measurement on a bad CRC or timeout
+bool SHT21::readValue(uint16_t &val)
+{
+  uint8_t data[3];
+  uint8_t cmd = (m_state == 1) ? eTempNoHoldCmd : eRHumidityNoHoldCmd;
+
+  if(Wire.requestFrom(eSHT21Address, 3) < 3) // NACK while still converting
+  {
+    while(Wire.available()) Wire.read();
+    if(millis() - m_cmdMil < convTime(m_res, m_state == 1) * 3) // give it more time
+      return false;
+    m_stats.noData++;
+  }
+  else
+  {
+    data[0] = Wire.read();
+    data[1] = Wire.read();
+    data[2] = Wire.read();
+    if(crc8(data, 2) == data[2])
+    {
+      val = ((data[0] << 8) | data[1]) & 0xFFFC; // clear status bits
+      return true;
+    }
+    m_stats.crcErrors++;
+  }
+
+  if(++m_retry <= SHT21_RETRIES)
+    startMeasurement(cmd);
+  else
+  {
+    m_stats.fails++;
+    m_state = 0; // try again next interval
+  }
+  return false;
+}
+
+// Read-modify-write the user register (keeps the reserved bits)
+void SHT21::writeResolution()
+{
+  Wire.beginTransmission(eSHT21Address);
+  Wire.write(eReadUserReg);
+  Wire.endTransmission();
+  if(Wire.requestFrom(eSHT21Address, 1) < 1)
+    return; // retry next reading
+  uint8_t reg = Wire.read();
+  reg = (reg & ~0x81) | m_res;
+  Wire.beginTransmission(eSHT21Address);
+  Wire.write(eWriteUserReg);
+  Wire.write(reg);
+  Wire.endTransmission();
+  m_bSetRes = false;
+}
+
+void SHT21::nextInterval()
+{
+  int32_t delta = (int32_t)m_temp - m_lastTemp;
+  bool bFirst = (m_lastTemp == 0);
+  m_lastTemp = m_temp;
+  if(bFirst) // nothing to compare with yet, keep the current (fast) interval
+    return;
+
+  if(m_bActive || delta >= SHT21_DELTA || delta <= -SHT21_DELTA)
+    m_interval = m_fast;
+  else if(m_interval < m_slow) // ease back to the slow rate
+    m_interval = min(m_interval + m_fast, m_slow);
+}
+
+// CRC-8, polynomial x^8 + x^5 + x^4 + 1 (0x31), init 0
+uint8_t SHT21::crc8(uint8_t *data, uint8_t len)
+{
+  uint8_t crc = 0;
+
+  for(uint8_t i = 0; i < len; i++)
+  {
+    crc ^= data[i];
+    for(uint8_t bit = 8; bit > 0; bit--)
+      crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+  }
+  return crc;
 }
 
 float SHT21::getTemperatureC()
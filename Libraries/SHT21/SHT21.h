@@ -27,6 +27,23 @@
 
 #include <inttypes.h>
 
+// Resolution settings for setResolution() (user register bits 7 and 0)
+enum SHT21_Res
+{
+  SHT21_RH12_T14 = 0x00, // default
+  SHT21_RH8_T12  = 0x01,
+  SHT21_RH10_T13 = 0x80,
+  SHT21_RH11_T11 = 0x81,
+};
+
+struct SHT21_Stats
+{
+  uint16_t reads;     // good readings
+  uint16_t crcErrors; // bad CRC (retried)
+  uint16_t noData;    // sensor didn't respond after conversion time
+  uint16_t fails;     // gave up after retries
+};
+
 class SHT21
 {
   typedef enum {
@@ -38,15 +55,26 @@ class SHT21
       eRHumidityHoldCmd  = 0xE5,
       eTempNoHoldCmd     = 0xF3,
       eRHumidityNoHoldCmd = 0xF5,
+      eWriteUserReg      = 0xE6,
+      eReadUserReg       = 0xE7,
   } HUM_MEASUREMENT_CMD_T;
   public:
     SHT21(uint8_t sda, uint8_t sdc, uint8_t seconds);
     void init(void);
     bool service(void); // returns true when both have been acquired
+    void setResolution(uint8_t res); // SHT21_Res (applied between readings)
+    void setInterval(uint8_t fastSeconds, uint8_t slowSeconds); // adaptive interval range
+    void setActive(bool bActive); // true = sample at the fast rate (HVAC running, etc.)
     float getTemperatureC(void);
     float getTemperatureF(void);
     float getRh(void);
+    SHT21_Stats m_stats;
   private:
+    bool  readValue(uint16_t &val);
+    void  startMeasurement(uint8_t cmd);
+    void  writeResolution(void);
+    void  nextInterval(void);
+    uint8_t crc8(uint8_t *data, uint8_t len);
     float calculateHumidity(uint16_t analogHumValue, uint16_t analogTempValue);
     float calculateTemperatureC(uint16_t analogTempValue);
     float calculateTemperatureF(uint16_t analogTempValue);
@@ -54,8 +82,17 @@ class SHT21
     uint8_t m_sdc;
     uint16_t m_temp;
     uint16_t m_rh;
-    uint8_t m_interval;
-    unsigned long m_mil;
+    uint16_t m_lastTemp;   // previous reading for rate of change, 0 = none yet (-46.85C)
+    uint8_t m_state;
+    uint8_t m_retry;
+    uint8_t m_res;         // requested resolution
+    bool    m_bSetRes;     // resolution change pending
+    bool    m_bActive;
+    uint32_t m_interval;   // current ms between readings
+    uint32_t m_fast;       // ms
+    uint32_t m_slow;       // ms
+    unsigned long m_mil;   // start of reading cycle
+    unsigned long m_cmdMil; // start of current conversion
 };
 
 #endif
@@ -13,6 +13,14 @@ XMLReader::XMLReader(void (*xml_callback)(int item, int idx, char *p, char *pTag
 {
   m_xml_callback = xml_callback;
   m_pTags = pTags;
+  m_etag[0] = 0;
+  m_modified[0] = 0;
+  m_allDone = 0;
+  for(m_tagCnt = 0; m_tagCnt < XML_TAGS && pTags[m_tagCnt].pszTag; m_tagCnt++) // hash the names once, any tag in the list can match in any order
+  {
+    m_hash[m_tagCnt] = nameHash(pTags[m_tagCnt].pszTag);
+    m_allDone |= 1UL << m_tagCnt;
+  }
 
   m_client.onConnect([](void* obj, AsyncClient* c) { (static_cast<XMLReader*>(obj))->_onConnect(c); }, this);
   m_client.onDisconnect([](void* obj, AsyncClient* c) { (static_cast<XMLReader*>(obj))->_onDisconnect(c); }, this);
@@ -38,11 +46,13 @@ bool XMLReader::begin(const char *pHost, int port, String path)
   m_pHost = pHost;
   m_path = path;
   m_tagIdx = 0;
-  m_tagState = 0;
+  m_done = 0;
   m_binValues = false;
-  m_pPtr = m_buffer;
-  m_pIn = m_pPtr;
-  m_pEnd = m_buffer + sizeof(m_buffer) - 2;
+  m_bHeaders = true;
+  m_bInTag = false;
+  m_bCapture = false;
+  m_tagLen = 0;
+  m_textLen = 0;
   return true;
 }
 
@@ -60,6 +70,10 @@ void XMLReader::_onConnect(AsyncClient* client)
   sendHeader("Accept-Encoding", "gzip, deflate, sdch");
   sendHeader("Accept-Language", "en-US,en;q=0.8");
   sendHeader("Cache-Control", "max-age=0");
+  if(m_etag[0])
+    sendHeader("If-None-Match", m_etag);
+  if(m_modified[0])
+    sendHeader("If-Modified-Since", m_modified);
   sendHeader("Connection", "keep-alive");
 
   m_client.add("\n", 1);
@@ -86,241 +100,224 @@ void XMLReader::sendHeader(const char *pHeaderName, int nHeaderValue) // integer
 void XMLReader::_onData(AsyncClient* client, char* data, size_t len)
 {
   (void)client;
-  char *dataEnd = data + len;
-
-  bool bDone = false;
-
-  if(!m_pTags[m_tagIdx].pszTag)  // already done
-      return;
-
-  do{
-    while(m_pIn < m_pEnd && data < dataEnd)
-    {
-      *m_pIn++ = *data++;
-    }
+  parse(data, len);
+}
 
-    *m_pIn = 0; // null terminate to make things easy
+// Scans the chunk in place.  Only a tag or value split across chunks is kept (m_tag, m_text)
+void XMLReader::parse(const char *data, size_t len)
+{
+  const char *pEnd = data + len;
 
-    if(!m_pTags[m_tagIdx].pszTag)  // completed
+  while(data < pEnd && m_done != m_allDone) // stop when all tags are done
+  {
+    if(m_bHeaders)                // header lines go through m_tag
     {
-      m_xml_callback(-1, XML_COMPLETED, NULL, NULL);
-      return;
+      char c = *data++;
+      if(c == '\n')
+      {
+        m_tag[m_tagLen] = 0;
+        headerDone();
+        m_tagLen = 0;
+      }
+      else if(c != '\r' && m_tagLen < XML_TAGLEN)
+        m_tag[m_tagLen++] = c;
     }
-
-    if(m_binValues) // if not in values, increment to next tag
+    else if(m_bInTag)
     {
-      nextValue();
+      const char *p = (const char *)memchr(data, '>', pEnd - data);
+      size_t n = (p ? p : pEnd) - data;
+      if(n > XML_TAGLEN - m_tagLen) n = XML_TAGLEN - m_tagLen;
+      memcpy(m_tag + m_tagLen, data, n);
+      m_tagLen += n;
+      if(p == NULL)             // rest of the tag is in the next chunk
+        return;
+      m_tag[m_tagLen] = 0;
+      m_bInTag = false;
+      data = p + 1;
+      tagDone();
     }
-    else if( combTag(m_pTags[m_tagIdx].pszTag, m_pTags[m_tagIdx].pszAttr, m_pTags[m_tagIdx].pszValue))   // scan for next tag
+    else
     {
-      m_binValues = true;
-      m_valIdx = 0;
-    }
-    emptyBuffer();
-
-    if(data >= dataEnd && tagCnt() < 4 )  // this is just bad
-    {
-      bDone = true;
+      const char *p = (const char *)memchr(data, '<', pEnd - data);
+      if(m_bCapture)
+      {
+        size_t n = (p ? p : pEnd) - data;
+        if(n > XML_TEXTLEN - m_textLen) n = XML_TEXTLEN - m_textLen;
+        memcpy(m_text + m_textLen, data, n);
+        m_textLen += n;
+      }
+      if(p == NULL)
+        return;
+      if(m_bCapture)
+        textDone();
+      m_bInTag = true;
+      m_tagLen = 0;
+      data = p + 1;
     }
-  }while(!bDone);
+  }
 }
 
-void XMLReader::emptyBuffer()
+// A header line is in m_tag
+void XMLReader::headerDone()
 {
-  if(m_pPtr >= m_pEnd)	// all bytes are used.  Just reset
+  if(m_tag[0] == 0)             // blank line, the document follows
   {
-    m_pPtr = m_buffer;
-    m_pIn = m_buffer;
+    m_bHeaders = false;
+    return;
   }
-  else if(m_pPtr > m_buffer)	// remove all used bytes
+  if(!strncmp(m_tag, "HTTP/", 5))
   {
-    memcpy(m_buffer, m_pPtr, m_pEnd - m_pPtr); // shift remaining
-
-    m_pIn -= (m_pPtr - m_buffer);	// shift in-ptr back same as remaining data
-    m_pPtr = m_buffer;
+    char *p = strchr(m_tag, ' ');
+    if(p && atoi(p + 1) == 304)
+    {
+      m_done = m_allDone;       // nothing to read
+      m_xml_callback(-1, XML_NOT_MODIFIED, NULL, NULL);
+      return;
+    }
+    m_etag[0] = 0;              // new document, use only its own validators
+    m_modified[0] = 0;
   }
-}
-
-// Find a tag
-bool XMLReader::combTag(const char *pTagName, const char *pAttr, const char *pValue)
-{
-  switch(m_tagState)
+  else if(!strncasecmp(m_tag, "ETag: ", 6))
   {
-    case 0:                   // not in tag
-      if(!tagStart() )
-        return false;         // find start of a tag
-      if(*m_pPtr != '<')
-        return false;
-      m_tagState = 1;
-      m_pPtr++;
-      return false;
-    case 1:		                            // found a tag
-      if(tagCompare(m_pPtr, pTagName))
-      {
-        m_pTagName = pTagName;
-        m_pPtr += strlen(pTagName);
-        bool bFound = false;
-        if(!pAttr)              	    // no attribute required
-        {
-          bFound = true;
-          tagEnd();
-          IncPtr();
-          char *p = m_pPtr; // start of data in tag
-          tagStart(); // end of data
-          *m_pPtr++ = 0;
-          m_xml_callback(m_tagIdx, m_valIdx, p, m_pTag);
-          tagEnd(); // skip end tag
-        }
-        else while(*m_pPtr != '>' && m_pPtr < m_pEnd && !bFound) // find the correct attribute
-        {
-          if(tagCompare(m_pPtr++, pAttr))
-          {
-            m_pPtr += strlen(pAttr) + 1;
-            if(pValue)
-	        {
-              bFound = tagCompare(m_pPtr, pValue);
-            }
-            else                    // no value required
-            {
-              bFound = true;
-            }
-          }
-        }
-        if(tagEnd())        		    // skip past this tag
-          m_pPtr++;
-        m_tagState = 0;
-        return bFound;
-      }
-      else m_tagState = 2;
-      break;
-    case 2:						    	    // find possibly long end of tag
-      if(!tagEnd())                       // retry on next pass with more data
-        return false;
-      m_tagState = 0;
-      break;
+    strncpy(m_etag, m_tag + 6, sizeof(m_etag) - 1);
+    m_etag[sizeof(m_etag) - 1] = 0;
+  }
+  else if(!strncasecmp(m_tag, "Last-Modified: ", 15))
+  {
+    strncpy(m_modified, m_tag + 15, sizeof(m_modified) - 1);
+    m_modified[sizeof(m_modified) - 1] = 0;
   }
-  return false;
 }
 
-// Get next tag data
-bool XMLReader::nextValue()
+// A complete tag is in m_tag
+void XMLReader::tagDone()
 {
-  if(!tagStart())
-    return true;	                	// Find start of tag
-  IncPtr();
-  m_pTag = m_pPtr;
-  if(m_pPtr >= m_pEnd)
-   return false;
-
-  char *p = m_pPtr;
+  if(m_tag[0] == '?' || m_tag[0] == '!') // declaration or comment
+    return;
 
-  while(*p++ != '<')                  	// lookahead
+  if(m_tag[0] == '/')                    // an end tag
   {
-    if(p >= m_pEnd)
-      return true;                    // not enough data to continue
+    if(m_binValues && tagCompare(m_tag + 1, m_pTags[m_tagIdx].pszTag)) // end of value list
+      tagEnd();
+    return;
   }
 
-  if(*m_pPtr == '/')                      // an end tag
+  bool bEmpty = (m_tagLen && m_tag[m_tagLen - 1] == '/'); // <tag/> has no text
+
+  if(!m_binValues)
   {
-    IncPtr();
-    if(tagCompare(m_pPtr, m_pTags[m_tagIdx].pszTag)) // end of value list
+    int i = findTag();
+    if(i < 0)
+      return;
+    m_tagIdx = i;
+    m_valIdx = 0;
+    if(m_pTags[i].pszAttr)              // values are the tags inside this one
     {
-      m_tagIdx++;
-      m_binValues = false;
-      return true;
+      m_binValues = true;
+      return;
     }
   }
+  m_textLen = 0;                        // value is the text after this tag
+  m_bCapture = true;
+  if(bEmpty)
+    textDone();
+}
 
-  if(!tagEnd())
-    return true;    // end of start tag
-  *m_pPtr = 0;
-  IncPtr();
-  if(m_pPtr >= m_pEnd)
-    return false;
-
-  char *ptr = m_pPtr;	// data
-
-  if(!tagStart())
-    return true;
-
-  if(m_pPtr >= m_pEnd)
-    return false;
-
-  *m_pPtr++ = 0;		                    // null term data (unsafe increment)
-  if(m_pPtr >= m_pEnd)
-   return false;
-
-  m_xml_callback(m_tagIdx, m_valIdx, ptr, m_pTag);
+// index of the list entry matching the tag in m_tag, or -1
+int XMLReader::findTag()
+{
+  uint32_t h = nameHash(m_tag);
 
-  if(++m_valIdx >= m_pTags[m_tagIdx].valueCount)
+  for(int i = 0; i < m_tagCnt; i++)
   {
-      m_binValues = false;
-      m_tagIdx++;
+    const XML_tag_t *pT = &m_pTags[i];
+    if(m_hash[i] != h || (m_done & (1UL << i)) )
+      continue;
+    if(!tagCompare(m_tag, pT->pszTag))  // hash collision
+      continue;
+    if(pT->pszAttr && !attrCompare(m_tag + strlen(pT->pszTag), pT->pszAttr, pT->pszValue))
+      continue;                         // same tag, other attribute
+    return i;
   }
-  tagEnd();		                    	// skip past end of end tag
-  IncPtr();
-
-  return true;
+  return -1;
 }
 
-bool XMLReader::tagCompare(char *p1, const char *p2) // compare at lenngth of p2 with special chars
+// FNV-1a of the tag name, up to the attributes
+uint32_t XMLReader::nameHash(const char *p)
 {
-  while(*p2)
+  uint32_t h = 2166136261UL;
+
+  while(*p && *p != ' ' && *p != '/')
   {
-    if(*p1 == 0) return false;
-    if(*p1++ != *p2++) return false;
+    h ^= (uint8_t)*p++;
+    h *= 16777619UL;
   }
-  return (*p2 == 0 && (*p1 == ' ' || *p1 == '>' || *p1 == '=' || *p1 == '"') );
+  return h;
 }
 
-void XMLReader::IncPtr()
+// Value text ended (next < found)
+void XMLReader::textDone()
 {
-  if(++m_pPtr >= m_pEnd)                      // not entirely safe
-    m_pPtr--;
+  m_bCapture = false;
+  m_text[m_textLen] = 0;
+  m_xml_callback(m_tagIdx, m_valIdx, m_text, m_tag);
+
+  if(!m_binValues || ++m_valIdx >= m_pTags[m_tagIdx].valueCount)
+    tagEnd();
 }
 
-bool XMLReader::tagStart()
+// done with the current tag
+void XMLReader::tagEnd()
 {
-  while(*m_pPtr != '<')                       // find start of tag
-  {
-    if(++m_pPtr >= m_pEnd)
-      return false;
-  }
-  return true;
+  m_binValues = false;
+  m_done |= 1UL << m_tagIdx;
+  if(m_done == m_allDone)  // completed
+    m_xml_callback(-1, XML_COMPLETED, NULL, NULL);
 }
 
-int XMLReader::tagCnt()
+bool XMLReader::tagCompare(const char *p1, const char *p2) // compare at length of p2 with special chars
 {
-  char *p = m_pPtr;
-  int cnt = 0;
-
-  while(*p)                       // find start of tag
+  while(*p2)
   {
-    if(*p++ == '<') cnt++;
-    if(p >= m_pEnd)
-      return cnt;
+    if(*p1 == 0) return false;
+    if(*p1++ != *p2++) return false;
   }
-  return cnt;
+  return (*p1 == 0 || *p1 == ' ' || *p1 == '/' || *p1 == '=' || *p1 == '"' || *p1 == '\'');
 }
 
-bool XMLReader::tagEnd()
+// find attribute in the rest of the tag, and compare the value if given
+bool XMLReader::attrCompare(const char *p, const char *pAttr, const char *pValue)
 {
-  while(*m_pPtr != '>')                       // find end of tag
+  while((p = strchr(p, ' ')) != NULL)
   {
-    if(++m_pPtr >= m_pEnd)
-      return false;
+    if(tagCompare(++p, pAttr))
+    {
+      if(pValue == NULL)            // no value required
+        return true;
+      p += strlen(pAttr);
+      if(*p == '=') p++;
+      if(*p == '"' || *p == '\'') p++;
+      return tagCompare(p, pValue);
+    }
   }
-  return true;
+  return false;
 }
 
 void XMLReader::_onDisconnect(AsyncClient* client)
 {
   (void)client;
+  if(m_done != m_allDone)       // incomplete, don't ask for this one again
+  {
+    m_etag[0] = 0;
+    m_modified[0] = 0;
+  }
   m_xml_callback(-1, XML_DONE, NULL, NULL);
 }
 
 void XMLReader::_onTimeout(AsyncClient* client, uint32_t time)
 {
   (void)client;
+  m_etag[0] = 0;
+  m_modified[0] = 0;
   m_xml_callback(-1, XML_TIMEOUT, NULL, NULL);
 }
@@ -9,7 +9,8 @@ enum XML_Status
   XML_IDLE,
   XML_DONE,
   XML_COMPLETED,
-  XML_TIMEOUT
+  XML_TIMEOUT,
+  XML_NOT_MODIFIED, // 304, the last document is still current
 };
 
 struct XML_tag_t
@@ -20,24 +21,30 @@ struct XML_tag_t
   int16_t     valueCount;
 };
 
+#define XML_TAGLEN  100 // longest start tag kept (name and attributes), the rest is cut
+#define XML_TEXTLEN  64 // longest value kept
+#define XML_TAGS     32 // most entries in the tag list
+
 class XMLReader
 {
 public:
   XMLReader(void (*xml_callback)(int item, int idx, char *p, char *pTag), const XML_tag_t *pTags);
   bool  begin(const char *pHost, int port, String path);
+  void  parse(const char *data, size_t len); // scan the next part of the document
+  char  m_etag[48];      // validators of the last complete document, sent as If-None-Match/If-Modified-Since
+  char  m_modified[32];
 
 private:
-  bool  combTag(const char *pTagName, const char *pAttr, const char *pValue);
-  bool  nextValue(void);
-  bool  fillBuffer(char* data, size_t len);
-  void  emptyBuffer(void);
+  void  headerDone(void);
+  void  tagDone(void);
+  void  textDone(void);
+  void  tagEnd(void);
+  int   findTag(void);
+  uint32_t nameHash(const char *p);
   void  sendHeader(const char *pHeaderName, const char *pHeaderValue);
   void  sendHeader(const char *pHeaderName, int nHeaderValue);
-  bool  tagCompare(char *p1, const char *p2);
-  void  IncPtr(void);
-  bool  tagStart(void);
-  int   tagCnt(void);
-  bool  tagEnd(void);
+  bool  tagCompare(const char *p1, const char *p2);
+  bool  attrCompare(const char *p, const char *pAttr, const char *pValue);
 
   void  (*m_xml_callback)(int item, int idx, char *p, char *pTag);
 
@@ -50,18 +57,22 @@ private:
   void _onData(AsyncClient* client, char* data, size_t len);
 
   const char  *m_pHost;
-  char m_buffer[512];
   String m_path;
   const XML_tag_t *m_pTags;
-  char   *m_pPtr;
-  char   *m_pEnd;
-  char   *m_pIn;
-  char   *m_pTag;
-  const char *m_pTagName;
+  uint32_t m_hash[XML_TAGS]; // name hash of each tag in the list
+  uint32_t m_done;           // bit per tag read
+  uint32_t m_allDone;
+  uint8_t  m_tagCnt;
+  char   m_tag[XML_TAGLEN + 1];   // current tag without the < >, kept across chunks
+  char   m_text[XML_TEXTLEN + 1]; // value text, kept across chunks
+  uint8_t m_tagLen;
+  uint8_t m_textLen;
+  bool   m_bHeaders;  // reading the HTTP headers
+  bool   m_bInTag;    // between < and >
+  bool   m_bCapture;  // keeping text for a value
   bool   m_binValues;
-  int m_tagIdx;
+  int m_tagIdx; // tag being read
   int m_valIdx;
-  int8_t m_tagState;
 };
 
 #endif // XMLREADER_H
@@ -282,6 +282,16 @@ void HVAC::updateOutdoorTemp(int16_t outTemp)
   m_outTemp = outTemp;
 }
 
+void HVAC::updateOutdoorDew(int16_t dew)
+{
+  m_outDew = dew;
+}
+
+bool HVAC::outdoorMoist()
+{
+  return false;
+}
+
 void HVAC::resetFilter()
 {
   ee.filterMinutes = 0;
@@ -302,7 +312,7 @@ void HVAC::resetTotal()
   sendCmd("resettotal", 0);
 }
 
-void HVAC::setVar(String sCmd, int val) // remote settings
+void HVAC::setVar(const char *pCmd, int val) // remote settings
 {
 }
 
@@ -16,8 +16,10 @@
 #include "HVAC.h"
 #include <JsonParse.h> // https://github.com/CuriousTech/ESP8266-HVAC/tree/master/Libraries/JsonParse
 #include "display.h" // for display.Note()
+#include "Nextion.h"
 #include "WiFiManager.h"
 #include "eeMem.h"
+#include "HttpLines.h"
 #include <WebSocketsClient.h> // https://github.com/Links2004/arduinoWebSockets
 //switch WEBSOCKETS_NETWORK_TYPE to NETWORK_ESP8266_ASYNC in WebSockets.h
 #if (WEBSOCKETS_NETWORK_TYPE != NETWORK_ESP8266_ASYNC)
@@ -47,7 +49,8 @@ JsonParse remoteParse(remoteCallback);
 void startListener(void);
 void dataPage(AsyncWebServerRequest *request);
 void fcPage(AsyncWebServerRequest *request);
-int chartFiller(uint8_t *buffer, int maxLen, int index);
+struct chartState;
+size_t chartFiller(chartState &st, uint8_t *buffer, size_t maxLen);
 
 int xmlState;
 void GetForecast(void);
@@ -151,6 +154,30 @@ void startServer()
     request->send(200, "text/plain", String(ESP.getFreeHeap()));
   });
 
+  // display output queue stats
+  server.on("/nex", HTTP_GET, [](AsyncWebServerRequest *request){
+    String s = "{\"queued\":";
+    s += nex.queued();
+    s += ",\"peak\":";
+    s += nex.m_qPeak;
+    s += ",\"drain\":";
+    s += nex.m_drainTime;
+    s += ",\"bytes\":";
+    s += nex.m_txBytes;
+    s += ",\"pageBytes\":";
+    s += nex.m_pageBytes;
+    s += ",\"sent\":";
+    s += nex.m_propSent;
+    s += ",\"skipped\":";
+    s += nex.m_propSkipped;
+    s += ",\"lines\":";
+    s += display.m_poly.m_inCnt;
+    s += ",\"linesSent\":";
+    s += display.m_poly.m_outCnt;
+    s += "}";
+    request->send(200, "text/json", s);
+  });
+
   server.onNotFound([](AsyncWebServerRequest *request){
     //Handle Unknown Request
 //    request->send(404);
@@ -179,48 +206,78 @@ void startServer()
   fc_client.onTimeout([](void* obj, AsyncClient* c, uint32_t time) { fc_onTimeout(c, time); });
 }
 
-// Send the array formated chart data and any modified variables
-void dataPage(AsyncWebServerRequest *request)
+// One /data response being sent, kept in the response's filler
+struct chartState
 {
-  int32_t tb = 0; // time subtracted from entries (saves 5 bytes each)
-
-  AsyncResponseStream *response = request->beginResponseStream("text/javascript");
+  int32_t  tb;       // time subtracted from entries (saves 5 bytes each)
+  uint32_t last;     // time of the last entry made, skips newer ones added while sending
+  int      n;        // next history entry, 0 = latest
+  char     line[100]; // formatted but not all sent yet
+  uint8_t  pos;
+  uint8_t  len;
+  bool     bDone;
+};
+
+// Next piece of the output: the first entry with the opening statements, an entry, or the end
+static uint8_t chartLine(chartState &st)
+{
+  gPoint gpt;
+  int len = 0;
 
-  for(int entryIdx = 0; entryIdx < GPTS - 12; entryIdx++)
+  while(st.n < GPTS - 12 && display.getGrapthPoints(&gpt, st.n))
   {
-    gPoint gpt;
-    if( display.getGrapthPoints(&gpt, entryIdx) == false)
-      break;
-   
+    st.n++;
     if(gpt.time == 0)
       continue; // some glitch?
+    if(st.last && gpt.time >= st.last) // the history moved up while sending
+      continue;
+    st.last = gpt.time;
 
-    String out = "";
-    if(tb == 0) // first entry found
+    if(st.tb == 0) // first entry found
     {
-      tb = gpt.time - (60*60*26);  // subtract 26 hours form latest entry
-      out += "tb=";      // first data opening statements
-      out += tb;
-      out += "\ncost=";
-      out +=  String(hvac.m_fCostE + hvac.m_fCostG, 2);
-      out += "\ndata=[\n";
+      st.tb = gpt.time - (60*60*26);  // subtract 26 hours form latest entry
+      String cost = String(hvac.m_fCostE + hvac.m_fCostG, 2);
+      len = snprintf(st.line, sizeof(st.line), "tb=%ld\ncost=%s\ndata=[\n", (long)st.tb, cost.c_str()); // first data opening statements
     }
-    out += "[";         // [seconds/10, temp, rh, high, low, state],
-    out += (gpt.time - tb)/10;
-    out += ",";
-    out += gpt.temp;
-    out += ",";
-    out += gpt.bits.b.rh;
-    out += ",";
-    out += gpt.h;
-    out += ",";
-    out += gpt.l;
-    out += ",";
-    out += gpt.bits.u & 7;
-    out += "],";
-    response->print(out);
+    // [seconds/10, temp, rh, high, low, state],
+    len += snprintf(st.line + len, sizeof(st.line) - len, "[%lu,%d,%d,%d,%d,%d],", (unsigned long)((gpt.time - st.tb)/10),
+      gpt.temp, gpt.bits.b.rh, gpt.h, gpt.l, gpt.bits.u & 7);
+    return len;
+  }
+  st.bDone = true;
+  return snprintf(st.line, sizeof(st.line), "]\n");
+}
+
+// Chunked response filler, formats entries straight into the send buffer
+size_t chartFiller(chartState &st, uint8_t *buffer, size_t maxLen)
+{
+  size_t len = 0;
+
+  while(len < maxLen)
+  {
+    if(st.pos == st.len) // all of the last line sent
+    {
+      if(st.bDone)
+        break;
+      st.len = chartLine(st);
+      st.pos = 0;
+    }
+    size_t n = min(maxLen - len, (size_t)(st.len - st.pos));
+    memcpy(buffer + len, st.line + st.pos, n);
+    st.pos += n;
+    len += n;
   }
-  response->print("]\n");
+  return len; // 0 = done
+}
+
+// Send the array formated chart data and any modified variables
+void dataPage(AsyncWebServerRequest *request)
+{
+  chartState st;
+  memset(&st, 0, sizeof(st));
+
+  AsyncWebServerResponse *response = request->beginChunkedResponse("text/javascript",
+    [st](uint8_t *buffer, size_t maxLen, size_t index) mutable -> size_t { return chartFiller(st, buffer, maxLen); });
   request->send ( response );
 }
 
@@ -298,8 +355,6 @@ void secondsServer() // called once per second
      // Request data from main unit
      if(fc_client.connected() == false)
      {
-       display.m_fcData[0].temp = display.m_fcData[1].temp; // keep a copy of first 3hour data
-       display.m_fcData[0].tm = display.m_fcData[1].tm;
        IPAddress ip(ee.hostIp);
        fc_client.connect(ip, ee.hostPort);
      }
@@ -316,9 +371,8 @@ void parseParams(AsyncWebServerRequest *request)
   for ( uint8_t i = 0; i < request->params(); i++ ) {
     AsyncWebParameter* p = request->getParam(i);
     p->value().toCharArray(temp, 100);
-    String s = wifi.urldecode(temp);
-    Serial.println( i + " " + p->name() + ": " + s);
-    int val = s.toInt();
+    wifi.urldecode(temp);
+    int val = atoi(temp);
  
     switch( p->name().charAt(0)  )
     {
@@ -331,7 +385,7 @@ void parseParams(AsyncWebServerRequest *request)
       case 'H': // host  (from browser type: hTtp://thisip/?H=hostip&P=85)
           {
             IPAddress ip;
-            ip.fromString(s);
+            ip.fromString(temp);
             ee.hostIp = ip;
             startListener(); // reset the URI
           }
@@ -353,14 +407,15 @@ void parseParams(AsyncWebServerRequest *request)
           ee.tz = val;
           break;
       case 'P': // host port
-          ee.hostPort = s.toInt();
+          ee.hostPort = val;
           startListener();
           break;
       case 's': // SSID
-          s.toCharArray(ee.szSSID, sizeof(ee.szSSID));
+          strncpy(ee.szSSID, temp, sizeof(ee.szSSID));
+          ee.szSSID[sizeof(ee.szSSID) - 1] = 0;
           break;
       case 'p': // AP password
-          wifi.setPass(s.c_str());
+          wifi.setPass(temp);
           break;
     }
   }
@@ -429,14 +484,22 @@ void webSocketEvent(WStype_t type, uint8_t * payload, size_t length)
 void startListener()
 {
   IPAddress ip(ee.hostIp);
-  remoteParse.addList(jsonList1);
-  remoteParse.addList(jsonList2);
-  remoteParse.addList(jsonList3);
+  if(!remoteParse.addList(jsonList1) || !remoteParse.addList(jsonList2) || !remoteParse.addList(jsonList3))
+    display.Note("JSON lists too big"); // over JP_LISTS or JP_SLOTS, names would be ignored
   ws.onEvent(webSocketEvent);
   ws.begin(ip.toString().c_str(), ee.hostPort, "/ws");
 }
 
+// The response is read into fcNew and only replaces the forecast when all of a 200 came, a 304 keeps it
+struct fcScratch
+{
+  Forecast data[FC_CNT];
+  int8_t   col[FC_COLS][FC_CNT];
+};
 int fcIdx;
+fcScratch *fcNew; // allocated while connected
+void fc_onLine(char *pLine, bool bHeader);
+HttpLines fcLines(fc_onLine);
 
 void fc_onConnect(AsyncClient* client)
 {
@@ -447,38 +510,66 @@ void fc_onConnect(AsyncClient* client)
     "Host: ";
   s += ip.toString();
   s += "\nConnection: close\n"
-    "Accept: */*\n\n";
+    "Accept: */*\n";
+  fcLines.validators(s); // the server can answer 304 if it hasn't changed
+  s += "\n";
 
   fc_client.add(s.c_str(), s.length());
+  if(fcNew == NULL)
+    fcNew = (fcScratch *)malloc(sizeof(fcScratch));
+  if(fcNew)
+    memset(fcNew->col, FC_NONE, sizeof(fcNew->col));
   fcIdx = 0; // 0 is reserved
+  fcLines.begin();
 }
 
-// read data as comma delimited 'time,temp,rh' per line
-void fc_onData(AsyncClient* client, char* data, size_t len)
+// read the thermostat's /forecast, comma delimited 'time,temp' and the FcCol columns per line
+void fc_onLine(char *pLine, bool bHeader)
 {
-  while(fcIdx < FC_CNT-1 && *data)
+  if(bHeader || fcNew == NULL || fcLines.m_status != 200 || fcIdx >= FC_CNT-1)
+    return;
+
+  uint32_t tm = atoi(pLine);
+  if(tm == 0) // not data
+    return;
+  char *p = strchr(pLine, ',');
+  if(p == NULL)
+    return;
+  fcNew->data[fcIdx].tm = tm;
+  fcNew->data[fcIdx].temp = atoi(++p);
+  for(int c = 0; c < FC_COLS; c++) // optional columns
   {
-    uint32_t tm = atoi(data);
-    if(tm) // skip the headers
-    {
-      display.m_fcData[fcIdx].tm = tm;
-      while(*data && *data != ',') data ++;
-      if(*data == ',') data ++;
-      else return;
-      display.m_fcData[fcIdx].temp = atoi(data);
-      fcIdx++;
-    }
-    while(*data && *data != '\r' && *data != '\n') data ++;
-    while(*data == '\r' || *data == '\n') data ++;
+    p = strchr(p, ',');
+    if(p == NULL)
+      break;
+    p++;
+    fcNew->col[c][fcIdx] = (*p && *p != ',') ? atoi(p) : FC_NONE;
   }
-  display.m_fcData[fcIdx].tm = 0;
-  display.m_bUpdateFcstDone = true;
-  hvac.enable();
+  fcIdx++;
+  fcNew->data[fcIdx].tm = 0;
+}
+
+void fc_onData(AsyncClient* client, char* data, size_t len)
+{
+  (void)client;
+  fcLines.data(data, len);
 }
 
 void fc_onDisconnect(AsyncClient* client)
 {
   (void)client;
+  fcLines.end();
+  display.m_bUpdateFcstDone = true;
+  hvac.enable();
+  if(fcNew && fcIdx > 0 && fcLines.m_status == 200 && fcLines.m_bComplete)
+  {
+    memcpy(display.m_fcData, fcNew->data, (fcIdx + 1) * sizeof(Forecast)); // to the end marker
+    memcpy(display.m_fcCol, fcNew->col, sizeof(display.m_fcCol));
+    display.m_bFcChanged = true;
+    display.m_bFcSave = true;
+  }
+  free(fcNew);
+  fcNew = NULL;
 }
 
 void fc_onTimeout(AsyncClient* client, uint32_t time)
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# Stand-in forecast server for testing the thermostat's fetch paths
+#
+# Serves /Forecast.log (the local feed, 'time,temp,rh' lines) and /MapClick.php (a
+# recorded DWML document) with ETag and Last-Modified, answering 304 when the request
+# carries a matching If-None-Match or If-Modified-Since.
+#
+# Usage: fcserver.py [-p 83] [-l Forecast.log] [-x dwml.xml] [--chunked] [--mode ok|timeout|close|error]
+#   ok       normal 200/304 answers
+#   timeout  accept and never answer (thermostat timeout path)
+#   close    send the headers and half the body, then drop the connection
+#   error    500
+# Touch the served file to make the next request a 200 again.
+#
+# Point ipFcServer/nFcPort in WebHandler.cpp at this machine.  For the DWML path the thermostat
+# asks forecast.weather.gov, so that name has to resolve here (e.g. a local DNS override).
+
+import argparse
+import email.utils
+import hashlib
+import os
+import socketserver
+import time
+from http.server import BaseHTTPRequestHandler
+
+args = None
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def do_GET(self):
+        if args.mode == 'timeout':
+            time.sleep(3600)
+            return
+        if args.mode == 'error':
+            self.reply(500, b'error\n', 'text/plain')
+            return
+
+        path = self.path.split('?')[0]
+        if path == '/Forecast.log':
+            name, ctype = args.log, 'text/plain'
+        elif path == '/MapClick.php':
+            name, ctype = args.xml, 'application/xml'
+        else:
+            self.reply(404, b'not found\n', 'text/plain')
+            return
+        if not name or not os.path.exists(name):
+            self.reply(404, b'no file\n', 'text/plain')
+            return
+
+        with open(name, 'rb') as f:
+            body = f.read()
+        etag = '"%s"' % hashlib.md5(body).hexdigest()[:16]
+        mtime = int(os.path.getmtime(name))
+        modified = email.utils.formatdate(mtime, usegmt=True)
+
+        inm = self.headers.get('If-None-Match')
+        ims = self.headers.get('If-Modified-Since')
+        if inm == etag or (inm is None and ims and email.utils.parsedate_to_datetime(ims).timestamp() >= mtime):
+            self.send_response(304)
+            self.send_header('ETag', etag)
+            self.send_header('Content-Length', '0')
+            self.end_headers()
+            self.log_message('304 %s', name)
+            return
+
+        headers = {'ETag': etag, 'Last-Modified': modified}
+        if args.mode == 'close':
+            self.send_response(200)
+            self.send_header('Content-Type', ctype)
+            self.send_header('Content-Length', str(len(body)))
+            for k, v in headers.items():
+                self.send_header(k, v)
+            self.end_headers()
+            self.wfile.write(body[:len(body) // 2])
+            self.close_connection = True
+            return
+        self.reply(200, body, ctype, headers)
+
+    def reply(self, code, body, ctype, headers={}):
+        self.send_response(code)
+        self.send_header('Content-Type', ctype)
+        for k, v in headers.items():
+            self.send_header(k, v)
+        if args.chunked:
+            self.send_header('Transfer-Encoding', 'chunked')
+            self.end_headers()
+            for i in range(0, len(body), 500):
+                part = body[i:i + 500]
+                self.wfile.write(b'%x\r\n%s\r\n' % (len(part), part))
+            self.wfile.write(b'0\r\n\r\n')
+        else:
+            self.send_header('Content-Length', str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+        self.log_message('%d %s bytes', code, len(body))
+
+
+class Server(socketserver.ThreadingMixIn, socketserver.TCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+
+if __name__ == '__main__':
+    ap = argparse.ArgumentParser(description='Stand-in forecast server')
+    ap.add_argument('-p', '--port', type=int, default=83)
+    ap.add_argument('-l', '--log', default='Forecast.log', help='local feed file')
+    ap.add_argument('-x', '--xml', default=None, help='recorded DWML file')
+    ap.add_argument('--chunked', action='store_true', help='use chunked transfer encoding')
+    ap.add_argument('--mode', choices=['ok', 'timeout', 'close', 'error'], default='ok')
+    args = ap.parse_args()
+
+    print('serving on port %d, mode %s%s' % (args.port, args.mode, ', chunked' if args.chunked else ''))
+    Server(('', args.port), Handler).serve_forever()
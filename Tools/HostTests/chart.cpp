@@ -0,0 +1,120 @@
+// Remote /data: the chunked chartFiller() output against the old dataPage() text
+// chart.inc is chartState, chartLine() and chartFiller() cut from Remote/WebHandler.cpp (see run.sh)
+// Build with -fsanitize=address,undefined
+#include <vector>
+#include "host.h"
+#include "display.h"
+
+// stand-ins for the parts of the display and HVAC objects the filler reads
+struct ChartDisplay
+{
+  std::vector<gPoint> pts; // 0 = latest
+
+  bool getGrapthPoints(gPoint *pt, int n)
+  {
+    if(n < 0 || n >= (int)pts.size())
+      return false;
+    *pt = pts[n];
+    return true;
+  }
+} display;
+
+struct ChartHVAC
+{
+  float m_fCostE = 12.345;
+  float m_fCostG = 1.5;
+} hvac;
+
+#include "chart.inc"
+
+// what dataPage() printed before
+static std::string oldPage()
+{
+  std::string s;
+  char buf[64];
+  int32_t tb = 0;
+  for(int i = 0; i < GPTS - 12 && i < (int)display.pts.size(); i++)
+  {
+    gPoint &g = display.pts[i];
+    if(g.time == 0)
+      continue;
+    if(tb == 0)
+    {
+      tb = g.time - (60*60*26);
+      snprintf(buf, sizeof(buf), "tb=%ld\ncost=%.2f\ndata=[\n", (long)tb, hvac.m_fCostE + hvac.m_fCostG);
+      s += buf;
+    }
+    snprintf(buf, sizeof(buf), "[%lu,%d,%d,%d,%d,%d],", (unsigned long)((g.time - tb) / 10), g.temp, g.bits.b.rh, g.h, g.l, g.bits.u & 7);
+    s += buf;
+  }
+  return s + "]\n";
+}
+
+static void history(int n)
+{
+  display.pts.clear();
+  for(int i = 0; i < n; i++)
+  {
+    gPoint g;
+    memset(&g, 0, sizeof(g));
+    g.time = (i == 5) ? 0 : 1600000000 - i * 300; // with one glitch
+    g.temp = 700 + rand() % 60;
+    g.l = 690;
+    g.h = 760 - rand() % 3;
+    g.bits.b.rh = 400 + rand() % 200;
+    g.bits.u |= rand() & 7;
+    display.pts.push_back(g);
+  }
+}
+
+// stream it the way the library does, maxLen bytes at a time (0 = random)
+static std::string stream(size_t maxLen, int addAt = -1)
+{
+  chartState st;
+  memset(&st, 0, sizeof(st));
+  std::string s;
+  std::vector<uint8_t> buf;
+  for(int call = 0; ; call++)
+  {
+    size_t n = maxLen ? maxLen : ((rand() & 1) ? 1 + rand() % 8 : 1 + rand() % 1460);
+    buf.resize(n); // exact size so ASan sees any overrun
+    size_t len = chartFiller(st, &buf[0], n);
+    if(len == 0)
+      break;
+    s.append((char *)&buf[0], len);
+    if(call == addAt) // a new point arrives while sending
+    {
+      gPoint g = display.pts[0];
+      g.time += 300;
+      display.pts.insert(display.pts.begin(), g);
+    }
+  }
+  return s;
+}
+
+int main()
+{
+  long cases = 0;
+  srand(5);
+  for(int n = 0; n < GPTS; n++)
+  {
+    history(n);
+    std::string ref = oldPage();
+    static const size_t sizes[] = {1, 7, 64, 1460, 0, 0};
+    for(size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++, cases++)
+      if(stream(sizes[i]) != ref)
+      {
+        printf("chart: %d points at %zu bytes a call\n", n, sizes[i]);
+        return hostFail("chart", "output differs from the old page");
+      }
+    if(n > 20 && n < GPTS - 13) // room for one more without pushing the oldest out
+    {
+      std::string s = stream(0, 2);
+      if(s != ref)
+        return hostFail("chart", "a point added while sending changed the output");
+      cases++;
+    }
+  }
+  printf("chart: %ld streams of 0-%d points same as the old page (%zu bytes of state)\n", cases, GPTS - 1, sizeof(chartState));
+  return 0;
+}
@@ -0,0 +1,34 @@
+# Writes a recorded-style NOAA DWML forecast (HTTP response included) for xml.cpp
+# Usage: python3 dwml.py [out.xml]
+import datetime, random, sys
+random.seed(1)
+N=168
+t0=datetime.datetime(2018,3,1,12)
+def ts(t): return t.strftime('%Y-%m-%dT%H:%M:%S-05:00')
+o=[]
+o.append('HTTP/1.1 200 OK\r\nContent-Type: application/xml\r\n\r\n')
+o.append('<?xml version="1.0" encoding="ISO-8859-1"?>\n<dwml version="1.0" xmlns:xsd="http://www.w3.org/2001/XMLSchema" xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" xsi:noNamespaceSchemaLocation="http://graphical.weather.gov/xml/DWMLgen/schema/DWML.xsd">\n')
+o.append('  <head>\n    <product srsName="WGS 1984" concise-name="time-series" operational-mode="official">\n      <title>NOAA\'s National Weather Service Forecast Data</title>\n      <field>meteorological</field>\n      <category>forecast</category>\n      <creation-date refresh-frequency="PT1H">2018-03-01T11:38:52-05:00</creation-date>\n    </product>\n  </head>\n  <data>\n')
+o.append('    <location>\n      <location-key>point1</location-key>\n      <point latitude="41.78" longitude="-88.31"/>\n    </location>\n')
+for lay in ('k-p1h-n1-0',):
+  o.append('    <time-layout time-coordinate="local" summarization="none">\n      <layout-key>%s</layout-key>\n'%lay)
+  for i in range(N):
+    o.append('      <start-valid-time>%s</start-valid-time>\n      <end-valid-time>%s</end-valid-time>\n'%(ts(t0+datetime.timedelta(hours=i)),ts(t0+datetime.timedelta(hours=i+1))))
+  o.append('    </time-layout>\n')
+o.append('    <parameters applicable-location="point1">\n')
+for typ,name in [('hourly','Temperature'),('dew point','Dew Point Temperature'),('wind chill','Wind Chill Temperature'),('heat index','Heat Index Temperature')]:
+  o.append('      <temperature type="%s" units="Fahrenheit" time-layout="k-p1h-n1-0">\n        <name>%s</name>\n'%(typ,name))
+  for i in range(N):
+    o.append('        <value>%d</value>\n'%random.randint(20,80))
+  o.append('      </temperature>\n')
+for tag,typ in [('wind-speed','sustained'),('wind-speed','gust'),('cloud-amount','total'),('probability-of-precipitation','floating'),('humidity','relative'),('direction','wind'),('hourly-qpf','floating')]:
+  o.append('      <%s type="%s" units="percent" time-layout="k-p1h-n1-0">\n        <name>%s</name>\n'%(tag,typ,tag))
+  for i in range(N):
+    o.append('        <value xsi:nil="true"/>\n' if random.random()<0.05 else '        <value>%d</value>\n'%random.randint(0,100))
+  o.append('      </%s>\n'%tag)
+o.append('      <weather time-layout="k-p1h-n1-0">\n        <name>Weather Type, Coverage, and Intensity</name>\n')
+for i in range(N):
+  o.append('        <weather-conditions>\n          <value coverage="chance" intensity="light" additive="and" weather-type="rain showers" qualifier="none"/>\n        </weather-conditions>\n')
+o.append('      </weather>\n    </parameters>\n  </data>\n</dwml>\n')
+s=''.join(o)
+open(sys.argv[1] if len(sys.argv) > 1 else 'dwml.xml', 'w').write(s)
@@ -0,0 +1,104 @@
+// SensorFilter: the TempFilter chain against the old median-of-25 handling
+// on a synthetic indoor trace (slow swing, sensor noise, spikes, a step)
+#include <vector>
+#include "host.h"
+#include "SensorFilter.h"
+
+struct Score
+{
+  double rms;    // error against the true value, tenths
+  int    spike;  // worst error within 30 samples of a spike
+  int    step;   // samples to get 90% of the way after the step
+};
+
+template <class F> static Score run(F &f, const std::vector<int16_t> &truth, const std::vector<int16_t> &raw)
+{
+  Score sc = {0, 0, -1};
+  double sum = 0;
+  int n = 0, lastSpike = -100;
+  for(size_t i = 0; i < raw.size(); i++)
+  {
+    int16_t v = raw[i];
+    if(raw[i] - truth[i] > 50 || truth[i] - raw[i] > 50)
+      lastSpike = i;
+    if(!f.add(v))
+      continue;
+    int e = v - truth[i];
+    if(i >= 1500 && i < 2000) // the step
+    {
+      if(sc.step < 0 && v >= truth[i] - 3) // within 10% of the step
+        sc.step = i - 1500;
+      continue;
+    }
+    sum += (double)e * e; n++;
+    if((int)i - lastSpike < 30 && abs(e) > sc.spike)
+      sc.spike = abs(e);
+  }
+  sc.rms = sqrt(sum / n);
+  return sc;
+}
+
+// what Thermostat.ino did before the chain
+class OldMedian
+{
+public:
+  bool add(int16_t &v)
+  {
+    m.add(v);
+    float f;
+    if(m.getAverage(2, f) != m.OK) return false;
+    v = f;
+    return true;
+  }
+  RunningMedian<int16_t, 25> m;
+};
+
+class Raw
+{
+public:
+  bool add(int16_t &) { return true; }
+};
+
+int main()
+{
+  std::vector<int16_t> truth, raw;
+  srand(2);
+  for(int i = 0; i < 3000; i++) // 4s samples
+  {
+    int t = 720 + (int)(10 * sin(i / 200.0));
+    if(i >= 1500) t += 30; // 3.0 degree step (heat on, sun)
+    truth.push_back(t);
+    int v = t + rand() % 7 - 3; // +/-0.3 noise
+    if(i % 400 == 100) v += 300; // single wild reading
+    if(i % 400 == 300) v -= 150; // and a short burst
+    if(i % 400 >= 300 && i % 400 < 303) v -= 150;
+    raw.push_back(v);
+  }
+
+  Raw r; OldMedian o; TempFilter tf;
+  FilterChain< MedianStage<5>, KalmanStage<1, 9> > kf;
+  Score s[4] = { run(r, truth, raw), run(o, truth, raw), run(tf, truth, raw), run(kf, truth, raw) };
+  const char *name[4] = { "raw", "median 25 avg 2 (old)", "TempFilter", "median 5 + Kalman" };
+  printf("filter: error in tenths, step = samples to 90%% of a 3.0 step\n");
+  for(int i = 0; i < 4; i++)
+    printf("  %-22s rms %5.2f  near spikes %4d  step %d\n", name[i], s[i].rms, s[i].spike, s[i].step);
+
+  // the chain is the stages in order
+  MedianStage<21, 5> m; RateClamp<20> c;
+  tf.clear();
+  for(size_t i = 0; i < raw.size(); i++)
+  {
+    int16_t a = raw[i], b = raw[i];
+    bool ba = tf.add(a);
+    bool bb = m.add(b) && c.add(b);
+    if(ba != bb || (ba && a != b))
+      return hostFail("filter", "chain differs from the stages run by hand");
+  }
+  if(s[2].spike > s[1].spike)
+    return hostFail("filter", "TempFilter lets more of the spikes through than the old median");
+  if(s[2].rms > s[1].rms)
+    return hostFail("filter", "TempFilter has more error than the old median");
+  if(s[2].step > s[1].step)
+    return hostFail("filter", "TempFilter is slower to follow the step than the old median");
+  return 0;
+}
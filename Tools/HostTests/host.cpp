@@ -0,0 +1,68 @@
+// Definitions for the stub headers, enough to link the library and display code on the host
+#include "host.h"
+#include <ESPAsyncTCP.h>
+
+uint64_t hostUs;
+std::string hostTx;
+bool hostTxKeep;
+FILE *hostCapture;
+std::string hostRx;
+size_t hostRxAvail;
+size_t hostRxPos;
+
+unsigned long millis(){ return hostUs / 1000; }
+unsigned long micros(){ return hostUs; }
+void delay(unsigned long ms){ hostUs += ms * 1000; }
+void delayMicroseconds(unsigned us){ hostUs += us; }
+void yield(){}
+long random(long a, long b){ return (b > a) ? a + rand() % (b - a) : a; }
+void randomSeed(unsigned long s){ srand(s); }
+int analogRead(int){ return 0; }
+void pinMode(int, int){}
+void digitalWrite(int, int){}
+int digitalRead(int){ return 0; }
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t c){ return write(&c, 1); }
+size_t HardwareSerial::write(const uint8_t *b, size_t n)
+{
+  if(hostTxKeep) hostTx.append((const char *)b, n);
+  if(hostCapture) fwrite(b, 1, n, hostCapture);
+  return n;
+}
+size_t HardwareSerial::print(const char *s){ return write((const uint8_t *)s, strlen(s)); }
+size_t HardwareSerial::print(const String &s){ return print(s.c_str()); }
+size_t HardwareSerial::println(const char *s){ return print(s) + print("\r\n"); }
+int HardwareSerial::availableForWrite(){ return 128; }
+int HardwareSerial::available(){ return (hostRxAvail > hostRxPos) ? hostRxAvail - hostRxPos : 0; }
+int HardwareSerial::read(){ return available() ? (uint8_t)hostRx[hostRxPos++] : -1; }
+void HardwareSerial::begin(long){}
+size_t HardwareSerial::readBytesUntil(char, char *, size_t){ return 0; }
+
+// the TCP clients are fed by calling their _onData() directly
+bool AsyncClient::connect(const char *, uint16_t){ return true; }
+bool AsyncClient::connect(IPAddress, uint16_t){ return true; }
+bool AsyncClient::connected(){ return false; }
+void AsyncClient::stop(){}
+void AsyncClient::close(bool){}
+size_t AsyncClient::add(const char *, size_t n){ return n; }
+bool AsyncClient::send(){ return true; }
+size_t AsyncClient::space(){ return 1460; }
+void AsyncClient::setRxTimeout(uint32_t){}
+void AsyncClient::onConnect(std::function<void(void*,AsyncClient*)>, void *){}
+void AsyncClient::onDisconnect(std::function<void(void*,AsyncClient*)>, void *){}
+void AsyncClient::onTimeout(std::function<void(void*,AsyncClient*,uint32_t)>, void *){}
+void AsyncClient::onData(std::function<void(void*,AsyncClient*,void*,size_t)>, void *){}
+void AsyncClient::onError(std::function<void(void*,AsyncClient*,int8_t)>, void *){}
+
+double hostSecs()
+{
+  return (double)clock() / CLOCKS_PER_SEC;
+}
+
+int hostFail(const char *pName, const char *pMsg)
+{
+  printf("%s: FAIL %s\n", pName, pMsg);
+  return 1;
+}
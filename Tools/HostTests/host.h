@@ -0,0 +1,21 @@
+// Shared host side of the Arduino stubs in stub/
+#ifndef HOST_H
+#define HOST_H
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <time.h>
+#include <string>
+
+extern uint64_t hostUs;       // the clock, millis() = hostUs / 1000, delays add to it
+extern std::string hostTx;    // bytes written to Serial (when hostTxKeep is true)
+extern bool hostTxKeep;
+extern FILE *hostCapture;     // Serial output is also written here if set
+extern std::string hostRx;    // bytes Serial can read
+extern size_t hostRxAvail;    // how much of hostRx has arrived
+extern size_t hostRxPos;      // read position
+
+double hostSecs(void);        // CPU seconds, for timing loops
+int hostFail(const char *pName, const char *pMsg); // print a failure, returns 1
+
+#endif
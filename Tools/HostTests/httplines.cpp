@@ -0,0 +1,80 @@
+// HttpLines: a forecast response, plain and chunked, split at every offset, and cut short
+#include <vector>
+#include "host.h"
+#include "HttpLines.h"
+
+static std::string out;
+
+static void cb(char *p, bool bHeader)
+{
+  out += bHeader ? "H:" : "B:";
+  out += p;
+  out += "\n";
+}
+
+static HttpLines hl(cb);
+
+static std::string run(const std::string &s, size_t a, size_t b) // split at a and b
+{
+  out.clear();
+  hl.begin();
+  hl.data(s.data(), a);
+  hl.data(s.data() + a, b - a);
+  hl.data(s.data() + b, s.size() - b);
+  hl.end();
+  return out;
+}
+
+int main()
+{
+  std::string body;
+  for(int i = 0; i < 40; i++)
+  {
+    char buf[64];
+    sprintf(buf, "%u,%d,%d\r\n", 1520000000u + i * 10800, 30 + i, 50 + i);
+    body += buf;
+  }
+  body += "1520432000,71"; // last line without newline
+  std::string plain = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\n" + body;
+  char len[48];
+  sprintf(len, "Content-Length: %zu\r\n\r\n", body.size());
+  std::string sized = "HTTP/1.1 200 OK\r\n" + std::string(len) + body;
+  std::string chunked = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+  for(size_t o = 0; o < body.size(); o += 333)
+  {
+    std::string c = body.substr(o, 333);
+    char buf[16];
+    sprintf(buf, "%zx;x=1\r\n", c.size());
+    chunked += buf + c + "\r\n";
+  }
+  chunked += "0\r\n\r\n";
+
+  std::string ref = run(plain, 0, 0);
+  if(hl.m_status != 200)
+    return hostFail("httplines", "status line not read");
+  int bad = 0, n = 0;
+  for(size_t a = 0; a <= plain.size(); a++, n++)
+    if(run(plain, a, a) != ref) bad++;
+  std::string refc = run(chunked, 0, 0);
+  size_t skip = ref.find("B:");
+  if(refc.substr(refc.find("B:")) != ref.substr(skip)) { printf("chunked body differs\n%s\n", refc.c_str()); bad++; }
+  for(size_t a = 0; a <= chunked.size(); a++)
+    for(size_t b = a; b <= chunked.size(); b += 7, n++)
+      if(run(chunked, a, b) != refc || !hl.m_bComplete) bad++;
+
+  // m_bComplete only when the last chunk or Content-Length bytes came
+  run(sized, 0, 0);
+  if(!hl.m_bComplete) { printf("Content-Length response not complete\n"); bad++; }
+  for(size_t cut = 1; cut < sized.size(); cut++, n++)
+  {
+    run(sized.substr(0, cut), 0, 0);
+    if(hl.m_bComplete) bad++;
+  }
+  for(size_t cut = 1; cut <= chunked.size() - 5; cut++, n++) // up to before the "0" chunk
+  {
+    run(chunked.substr(0, cut), 0, 0);
+    if(hl.m_bComplete) bad++;
+  }
+  printf("httplines: %d splits and cuts, %d bad\n", n, bad);
+  return bad != 0;
+}
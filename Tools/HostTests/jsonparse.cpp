@@ -0,0 +1,118 @@
+// JsonParse: callbacks for the web commands and state messages, and parse speed
+// Usage: jsonparse [-p]   (-p prints the callbacks, for diffing two builds)
+// Build with -DHOST_BASE for a JsonParse before process() returned a result
+#include <vector>
+#include "host.h"
+#include "JsonParse.h"
+
+static std::string out;
+static bool bKeep = true; // off while timing
+static long hits;
+
+static void cb(int16_t iEvent, uint16_t iName, int iValue, char *psValue)
+{
+  hits++;
+  if(!bKeep)
+    return;
+  char buf[200];
+  snprintf(buf, sizeof(buf), "%d %u %d [%s]\n", iEvent, iName, iValue, psValue ? psValue : "");
+  out += buf;
+}
+
+static const char *jsonList1[] = { "state",  "temp", "rh", "tempi", "rhi", "rmt", NULL };
+static const char *cmdList[] = { "cmd", "key", "data", "sum", "fanmode", "mode", "heatmode", "resettotal", "resetfilter",
+  "fanpostdelay", "cyclemin", "cyclemax", "idlemin", "cyclethresh", "cooltempl", "cooltemph", "heattempl", "heattemph",
+  "eheatthresh", "override", "overridetime", "humidmode", "humidl", "humidh", "adj", "fanpretime", "fancycletime",
+  "rmtflgs", "awaytime", "awaydelta", "away", "ppk", "ccf", "cfm", "ce", "cg", "fcrange", "fcdisp", "save", "tz", "cw",
+  "fw", "frnw", "hfw", "ffp", NULL };
+static const char *jsonList3[] = { "alert", NULL };
+
+static JsonParse jp(cb);
+
+static bool parse(const char *ev, const char *data)
+{
+  std::vector<char> d(data, data + strlen(data) + 1);
+#ifdef HOST_BASE
+  jp.process((char *)ev, &d[0]);
+  return true;
+#else
+  return jp.process((char *)ev, &d[0]);
+#endif
+}
+
+int main(int argc, char **argv)
+{
+#ifdef HOST_BASE
+  jp.addList(jsonList1);
+  jp.addList(cmdList);
+  jp.addList(jsonList3);
+#else
+  if(!jp.addList(jsonList1) || !jp.addList(cmdList) || !jp.addList(jsonList3))
+    return hostFail("jsonparse", "the firmware lists don't fit (JP_LISTS, JP_SLOTS)");
+#endif
+
+  std::string all = "{\"key\":\"pw\""; // every command once, and 2 unknown keys
+  for(int i = 2; cmdList[i]; i++)
+    all += std::string(",\"") + cmdList[i] + "\":1";
+  all += ",\"nope\":1,\"zz\":2}";
+
+  static const char *tests[][2] = {
+    {"cmd", "{\"key\":\"abc123\",\"cooltemph\":850,\"cooltempl\":800,\"heattemph\":740,\"heattempl\":700,\"overridetime\":600,\"fancycletime\":0,\"awaydelta\":-40}"},
+    {"cmd", "{sum:0}"},
+    {"cmd", "{data:0}"},
+    {"cmd", "{\"key\":\"abc\",\"fanmode\":true}"},
+    {"state", "{\"temp\":72.5,\"rh\":45.2,\"tempi\":725,\"rhi\":452,\"rmt\":1}"},
+    {"alert", "{\"x\":1}"},
+    {"cmd", "{\"key\":\"a\",\"mode\":{\"fanmode\":1},\"heatmode\":2}"},
+    {"cmd", all.c_str()},
+  };
+  const int n = sizeof(tests) / sizeof(tests[0]);
+  for(int i = 0; i < n; i++)
+    parse(tests[i][0], tests[i][1]);
+  if(argc > 1 && !strcmp(argv[1], "-p"))
+  {
+    printf("%s", out.c_str());
+    return 0;
+  }
+
+  int rc = 0;
+#ifndef HOST_BASE
+  // the result and unknown key count the /batch and /s pages use
+  static const struct { const char *p; bool b; uint16_t unknown; } res[] = {
+    {"{\"key\":\"x\",\"cooltemph\":850}", true, 0},
+    {"{\"cooltemph\":850,\"bogus\":1,key:x}", true, 1},
+    {"{\"cooltemph\":850", false, 0},
+    {"{\"a\"::1}", false, 0},
+  };
+  for(uint8_t i = 0; i < sizeof(res) / sizeof(res[0]); i++)
+  {
+    bool b = parse("cmd", res[i].p);
+    if(b != res[i].b || jp.m_unknown != res[i].unknown)
+    {
+      printf("jsonparse: %s gave %d, %u unknown\n", res[i].p, b, jp.m_unknown);
+      rc = 1;
+    }
+  }
+  if(rc == 0)
+    printf("jsonparse: results and unknown key counts ok\n");
+#endif
+
+  bKeep = false;
+  size_t bytes = 0;
+  long reps = 0;
+  double t = hostSecs();
+  for(; hostSecs() - t < 0.5; reps++)
+  {
+    parse(tests[reps % (n - 1)][0], tests[reps % (n - 1)][1]);
+    bytes += strlen(tests[reps % (n - 1)][1]);
+  }
+  printf("  command sized messages  %6.1f MB/s\n", bytes / (hostSecs() - t) / 1e6);
+
+  hits = 0;
+  reps = 0;
+  t = hostSecs();
+  for(; hostSecs() - t < 0.5; reps++)
+    parse("cmd", all.c_str());
+  printf("  every command key       %6.2fM keys/s\n", hits / (hostSecs() - t) / 1e6);
+  return rc;
+}
@@ -0,0 +1,124 @@
+// JsonTokenizer: mutated and random input fed whole and in 1-9 byte pieces, an SSE
+// stream through JsonClient split at every pair of offsets, and tokenizer speed
+// Build with -fsanitize=address,undefined
+#include <vector>
+#include "host.h"
+#include "JsonTokenizer.h"
+#define private public // to feed _onData() directly
+#include "JsonClient.h"
+#undef private
+
+static std::string out;
+
+static void tcb(void *obj, const char *pPath, const char *pKey, char *pValue, uint8_t type)
+{
+  out += pPath;
+  out += '|';
+  out += pKey;
+  out += '|';
+  out += pValue;
+  out += '|';
+  out += char('0' + type);
+  out += '\n';
+}
+
+static void cb(int16_t iEvent, uint16_t iName, int iValue, char *psValue)
+{
+  char buf[200];
+  snprintf(buf, sizeof(buf), "%d %u %d [%s]\n", iEvent, iName, iValue, psValue ? psValue : "");
+  out += buf;
+}
+
+static const char *l1[] = { "state", "temp", "rh", "x", NULL };
+static const char *l2[] = { "alert", "msg", NULL };
+
+static const char *seeds[] = {
+  "{\"a\":1,\"b\":[1,2,{\"c\":\"x\\u00e9\\n\"}],\"d\":{\"e\":true,\"f\":null,\"g\":-1.5e3}}",
+  "{sum:0}", "{data:0,key:abc def }", "[[[[[[[[[[1]]]]]]]]]]", "{\"k\":\"" "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\"}",
+};
+
+static JsonClient jc(cb);
+
+int main()
+{
+  JsonTokenizer tok(tcb, NULL);
+  srand(1);
+  long cases = 0;
+  for(int it = 0; it < 200000; it++)
+  {
+    std::string s = seeds[it % 5];
+    int m = rand() % 6;
+    for(int k = 0; k < m; k++)
+    {
+      int op = rand() % 3, pos = s.size() ? rand() % s.size() : 0;
+      const char set[] = "{}[]\":,\\u \n0aetn";
+      if(op == 0) s.erase(pos, 1);
+      else if(op == 1) s.insert(pos, 1, (rand() % 4) ? set[rand() % (sizeof(set)-1)] : (char)rand());
+      else s[pos] = (char)rand();
+    }
+    if(it % 7 == 0) // all random
+    {
+      s.resize(rand() % 300);
+      for(size_t i = 0; i < s.size(); i++)
+        s[i] = rand();
+    }
+    out.clear();
+    tok.begin();
+    tok.feed(s.data(), s.size());
+    tok.end();
+    std::string a = out;
+
+    out.clear();
+    tok.begin();
+    for(size_t p = 0; p < s.size(); )
+    {
+      size_t n = 1 + rand() % 9;
+      if(p + n > s.size()) n = s.size() - p;
+      tok.feed(s.data() + p, n);
+      p += n;
+    }
+    tok.end();
+    if(a != out)
+      return hostFail("jsontok", "split input gave different events");
+    cases++;
+  }
+  printf("jsontok: %ld fuzzed inputs, same events whole and split\n", cases);
+
+  // SSE stream through JsonClient at every split
+  const char *sse = ":ok\r\nevent: state\r\ndata: {\"temp\":72.5,\"rh\":45}\r\n\r\nevent: alert\ndata: {\"msg\":\"hi there\"}\n\ndata: {\"x\":3}\n\n";
+  jc.addList(l1);
+  jc.addList(l2);
+  size_t L = strlen(sse);
+  std::vector<char> b(sse, sse + L);
+  out.clear();
+  jc._onData(NULL, &b[0], L);
+  std::string ref = out;
+  if(ref.size() == 0)
+    return hostFail("jsontok", "no events from the SSE stream");
+  for(size_t i = 0; i <= L; i++)
+    for(size_t j = i; j <= L; j += 3)
+    {
+      b.assign(sse, sse + L);
+      out.clear();
+      jc._onData(NULL, &b[0], i);
+      jc._onData(NULL, &b[i], j - i);
+      jc._onData(NULL, &b[j], L - j);
+      if(out != ref)
+        return hostFail("jsontok", "SSE stream split gave different events");
+    }
+  printf("jsontok: SSE stream same at every split\n");
+
+  std::string big;
+  while(big.size() < 1000000) big += seeds[0];
+  out.reserve(1 << 20);
+  double t = hostSecs();
+  for(int r = 0; r < 20; r++)
+  {
+    out.clear();
+    tok.begin();
+    tok.feed(big.data(), big.size());
+    tok.end();
+  }
+  printf("  tokenizer %.0f MB/s (with a callback per value)\n", 20.0 * big.size() / (hostSecs() - t) / 1e6);
+  return 0;
+}
@@ -0,0 +1,71 @@
+// RunningMedian: results against a sorted copy of the window, and query speed
+#include <algorithm>
+#include <vector>
+#include "host.h"
+#include "RunningMedian.h"
+
+template <int N> static int check(long &q)
+{
+  RunningMedian<int16_t, N> rm;
+  std::vector<int16_t> win;
+
+  for(int i = 0; i < 20000; i++)
+  {
+    int16_t v = (i % 3) ? rand() % 1000 - 500 : rand() % 8; // with repeats
+    rm.add(v);
+    win.push_back(v);
+    if((int)win.size() > N) win.erase(win.begin());
+    std::vector<int16_t> s(win);
+    std::sort(s.begin(), s.end());
+
+    int16_t med, lo, hi;
+    float avg, avg3;
+    rm.getMedian(med);
+    rm.getLowest(lo);
+    rm.getHighest(hi);
+    rm.getAverage(3, avg3);
+    rm.getAverage(avg);
+    int n3 = min((int)s.size(), 3), st = (s.size() - n3) / 2;
+    float ref3 = 0, ref = 0;
+    for(int j = 0; j < n3; j++) ref3 += s[st + j];
+    for(size_t j = 0; j < s.size(); j++) ref += s[j];
+    ref3 /= n3; ref /= s.size();
+    if(med != s[s.size()/2] || lo != s[0] || hi != s.back() || fabs(avg3 - ref3) > 0.01 || fabs(avg - ref) > 0.01)
+    {
+      printf("N=%d sample %d: median %d want %d\n", N, i, med, s[s.size()/2]);
+      return 1;
+    }
+    q++;
+  }
+  return 0;
+}
+
+// one add() plus the median, as the sensors use it
+template <int N> static void bench()
+{
+  RunningMedian<int16_t, N> rm;
+  int16_t v;
+  long sum = 0, n = 0;
+  double t = hostSecs();
+  for(; hostSecs() - t < 0.5; )
+    for(int i = 0; i < 10000; i++, n++)
+    {
+      rm.add(rand() & 1023);
+      rm.getMedian(v);
+      sum += v;
+    }
+  printf("  N=%-3d %8.2fM add+median/s (%ld)\n", N, n / (hostSecs() - t) / 1e6, sum & 1);
+}
+
+int main()
+{
+  long q = 0;
+  srand(1);
+  if(check<1>(q) || check<5>(q) || check<25>(q) || check<255>(q))
+    return hostFail("median", "differs from the sorted window");
+  printf("median: %ld windows ok (N = 1, 5, 25, 255)\n", q);
+  bench<5>();
+  bench<25>();
+  bench<255>();
+  return 0;
+}
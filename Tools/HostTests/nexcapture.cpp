@@ -0,0 +1,151 @@
+// Captures what the display code sends to the panel for each screen, for Tools/NexEmu
+// Writes <dir>/refreshAll.bin, forecast.bin, clock.bin, clocksec.bin, clockmin.bin,
+// clockhour.bin (an hour of seconds) and graph0-3.bin (6h, 1d, 3d, 1w) from a synthetic week of history and forecast
+// Usage: nexcapture [dir]
+// Build with -DHOST_BASE_CLOCK for display code before updateClock() took a refresh flag,
+// and -DHOST_BASE_DRAW for display code that drew the forecast and graph in one call
+#include <math.h>
+#include "host.h"
+#define private public // to fill the history and call the draw functions directly
+#include "display.h"
+#include "Nextion.h"
+#include "HVAC.h"
+#include "eeMem.h"
+#include "WiFiManager.h"
+#undef private
+#include <EEPROM.h>
+#include <FS.h>
+#include <TimeLib.h>
+
+#ifdef HOST_BASE_CLOCK
+#define updateClock(bRef) updateClock() // redrew the whole clock every second
+#endif
+
+static time_t tnow = 1539000000;
+static std::string dir = ".";
+
+WiFiClass WiFi;
+EEPROMClass EEPROM;
+FSClass SPIFFS;
+HVAC hvac;
+eeMem eemem;
+WiFiManager wifi;
+Display display;
+
+void EEPROMClass::begin(int){}
+bool EEPROMClass::commit(){ return true; }
+uint8_t EEPROMClass::read(int){ return 0; }
+void EEPROMClass::write(int, uint8_t){}
+int32_t WiFiClass::RSSI(){ return -60; }
+bool FSClass::begin(){ return true; }
+File FSClass::open(const char *, const char *){ return File(); }
+File::operator bool() const { return false; } // no saved forecast
+size_t File::size(){ return 0; }
+size_t File::read(uint8_t *, size_t){ return 0; }
+size_t File::write(const uint8_t *, size_t n){ return n; }
+void File::close(){}
+WiFiManager::WiFiManager(){}
+bool WiFiManager::isCfg(){ return false; }
+void WiFiManager::setPass(const char *){}
+void WiFiManager::setSSID(int){}
+void WsSend(char *, const char *){}
+
+time_t now(){ return tnow; }
+int hour(){ return (tnow / 3600) % 24; }
+int minute(){ return (tnow / 60) % 60; }
+int second(){ return tnow % 60; }
+int hourFormat12(){ int h = hour() % 12; return h ? h : 12; }
+bool isPM(){ return hour() >= 12; }
+int weekday(time_t t){ return ((t / 86400) + 4) % 7 + 1; }
+int weekday(){ return weekday(tnow); }
+int hour(time_t t){ return (t / 3600) % 24; }
+int minute(time_t t){ return (t / 60) % 60; }
+
+// finish the drawing loop() would continue, send what is queued, then direct the panel bytes to the next file
+static void capture(const char *pName)
+{
+#ifndef HOST_BASE_DRAW
+  while(display.m_drawJob)
+  {
+    delay(1);
+    display.checkNextion();
+  }
+#endif
+  nex.sync();
+  if(hostCapture)
+    fclose(hostCapture);
+  hostCapture = pName ? fopen((dir + "/" + pName).c_str(), "wb") : NULL;
+}
+
+int main(int argc, char **argv)
+{
+  if(argc > 1)
+    dir = argv[1];
+  srand(1);
+  ee.tz = 0;
+  ee.fcRange = 23;
+  ee.fcDisplay = 46;
+  hvac.m_inTemp = 720;
+  hvac.m_targetTemp = 740;
+  hvac.m_rh = 450;
+  memset(display.m_points, 255, sizeof(display.m_points));
+  memset(display.m_hours, 255, sizeof(display.m_hours));
+
+  // one week of 5 minute history, heating cycles on a slow swing
+  time_t start = tnow - 7*86400;
+  for(time_t t = start; t < start + 7*86400; t += 300)
+  {
+    tnow = t;
+    double m = (t - start) / 60.0;
+    double ph = fmod(m, 90.0) / 90.0;
+    hvac.m_inTemp = 715 + (int)(20 * sin(m / 400.0)) + (int)((ph < 0.3) ? ph / 0.3 * 8 : 8 - (ph - 0.3) / 0.7 * 8);
+    hvac.m_rh = 450 + (int)(50 * sin(m / 700.0)) + rand() % 4;
+    display.addGraphPoints();
+  }
+  tnow = start + 7*86400;
+
+  // 40 forecast entries 3 hours apart
+  for(int i = 0; i < 41; i++)
+  {
+    display.m_fcData[i].tm = tnow - 3*3600 + i * 3*3600;
+    display.m_fcData[i].temp = 60 + (int)(15 * sin(i * 3 * 2 * M_PI / 24)) + i / 8;
+  }
+  display.m_fcData[41].tm = 0;
+
+  nex.setPage("Thermostat");
+  capture("refreshAll.bin");
+  display.refreshAll();
+  display.oneSec();
+  capture("forecast.bin");
+  display.drawForecast(true);
+  capture("clock.bin");
+  nex.setPage("clock");
+  display.updateClock(true);
+  capture("clocksec.bin"); // 2 normal seconds
+  tnow++;
+  display.updateClock(false);
+  tnow++;
+  display.updateClock(false);
+  capture("clockmin.bin"); // the minute hand moves
+  tnow += 60;
+  display.updateClock(false);
+  for(int z = 0; z < 4; z++)
+  {
+    char name[16];
+    snprintf(name, sizeof(name), "graph%d.bin", z);
+    capture(name);
+    display.m_graphZoom = z;
+    nex.setPage("graph");
+    display.fillGraph();
+  }
+  capture("clockhour.bin"); // after the graphs so they see the same history window
+  nex.setPage("clock");
+  display.updateClock(true);
+  for(int i = 0; i < 3600; i++)
+  {
+    tnow++;
+    display.updateClock(false);
+  }
+  capture(NULL);
+  return 0;
+}
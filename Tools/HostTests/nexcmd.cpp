@@ -0,0 +1,94 @@
+// Nextion command encoder: exact bytes on the wire, heap use and speed
+#include <new>
+#include "host.h"
+#include "Nextion.h"
+
+Nextion nex;
+static long allocs;
+
+void *operator new(size_t n)
+{
+  allocs++;
+  return malloc(n);
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static std::string sent()
+{
+  nex.sync();
+  std::string s = hostTx;
+  hostTx.clear();
+  for(size_t i; (i = s.find("\xFF\xFF\xFF")) != std::string::npos; )
+    s.replace(i, 3, "|");
+  return s;
+}
+
+static int expect(const char *pWhat, const char *pWant)
+{
+  std::string s = sent();
+  if(s == pWant)
+    return 0;
+  printf("nexcmd: %s sent [%s] want [%s]\n", pWhat, s.c_str(), pWant);
+  return 1;
+}
+
+int main()
+{
+  int bad = 0;
+  hostTxKeep = true;
+
+  nex.itemText(1, "abc");
+  bad += expect("itemText", "t1.txt=\"abc\"|");
+  nex.itemText(1, "abc");
+  bad += expect("same text again", "");
+  nex.itemNum(2, -12);
+  bad += expect("itemNum", "n2.val=-12|");
+  nex.line(10, 20, 300, 2, 65535);
+  bad += expect("line", "line 10,20,300,2,65535|");
+  nex.fill(0, 0, 320, 240, 0);
+  bad += expect("fill", "fill 0,0,320,240,0|");
+
+  nex.batch(true); // held, but in the order they were done
+  nex.itemNum(2, 5);
+  nex.line(1, 2, 3, 4, 5);
+  nex.itemText(1, "x");
+  nex.itemText(1, "y");
+  if(hostTx.size())
+    bad += hostFail("nexcmd", "batch sent before batch(false)");
+  nex.batch(false);
+  bad += expect("batch", "n2.val=5|line 1,2,3,4,5|t1.txt=\"y\"|");
+
+  nex.batch(true); // text too long for the model keeps its place after earlier changes
+  nex.itemNum(2, 6);
+  nex.itemText(1, "a text longer than the model");
+  nex.itemNum(2, 7);
+  if(hostTx.size())
+    bad += hostFail("nexcmd", "long text sent before batch(false)");
+  nex.batch(false);
+  bad += expect("long text", "n2.val=6|t1.txt=\"a text longer than the model\"|n2.val=7|");
+
+  // per-second style traffic: numbers, short text and lines
+  hostTxKeep = false;
+  char sz[8];
+  long n = 0;
+  allocs = 0;
+  double t = hostSecs();
+  for(int r = 0; r < 200000; r++, n += 4)
+  {
+    nex.batch(true);
+    nex.itemNum(2, r & 1023);
+    snprintf(sz, sizeof(sz), "%d", r & 4095);
+    nex.itemText(3, sz);
+    nex.line(r % 320, 10, 300 - r % 200, 200, r);
+    nex.itemFp(4, r & 511);
+    nex.batch(false);
+    nex.sync();
+  }
+  t = hostSecs() - t;
+  printf("nexcmd: %.0f ns per command, %ld heap allocations in %ld commands, %u bytes\n",
+    t / n * 1e9, allocs, n, nex.m_txBytes);
+  if(allocs)
+    bad += hostFail("nexcmd", "encoder allocated");
+  return bad != 0;
+}
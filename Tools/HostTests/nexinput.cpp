@@ -0,0 +1,70 @@
+// Nextion input parser: a replayed capture fed in pieces of every size, and random streams
+// Build with -fsanitize=address,undefined to catch overruns of the event buffer
+#include <vector>
+#include "host.h"
+#include "Nextion.h"
+
+Nextion nex;
+
+// feed hostRx to service() chunk bytes at a time (0 = random 1-7), return the events
+static std::string run(size_t chunk)
+{
+  std::string r;
+  char buf[NEX_RX + 1];
+  hostRxPos = hostRxAvail = 0;
+  while(hostRxPos < hostRx.size())
+  {
+    hostRxAvail += chunk ? chunk : 1 + rand() % 7;
+    if(hostRxAvail > hostRx.size())
+      hostRxAvail = hostRx.size();
+    int len;
+    while((len = nex.service(buf)) != 0)
+    {
+      char t[16];
+      snprintf(t, sizeof(t), "[%02X:%d]", (uint8_t)buf[0], len);
+      r += t;
+      if(buf[0] == 0x70)
+        r += buf + 1;
+    }
+  }
+  return r;
+}
+
+int main()
+{
+  // startup, touch, string, page, number with FF bytes, touch with FF data, error code
+  static const uint8_t cap[] = {0x00,0x00,0x00,0xFF,0xFF,0xFF, 0x88,0xFF,0xFF,0xFF, 0x65,0x00,0x0B,0x01,0xFF,0xFF,0xFF,
+    0x70,'1','2','3','4','5',0xFF,0xFF,0xFF, 0x66,0x04,0xFF,0xFF,0xFF, 0x71,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+    0x65,0x04,0xFF,0x00,0xFF,0xFF,0xFF, 0x1A,0xFF,0xFF,0xFF};
+  const char *want = "[00:1][88:1][65:4][70:6]12345[66:2][71:5][65:4][1A:1]";
+
+  hostRx.assign((const char *)cap, sizeof(cap));
+  for(size_t chunk = 0; chunk <= sizeof(cap); chunk++)
+  {
+    std::string s = run(chunk);
+    if(s != want)
+    {
+      printf("nexinput: chunk %zu gave %s\n  want %s\n", chunk, s.c_str(), want);
+      return 1;
+    }
+  }
+  if(nex.getPage() != 4)
+    return hostFail("nexinput", "0x66 didn't set the page");
+  printf("nexinput: capture ok at every chunk size\n");
+
+  srand(2);
+  long events = 0;
+  for(int it = 0; it < 20000; it++)
+  {
+    hostRx.clear();
+    int n = rand() % 500;
+    for(int i = 0; i < n; i++)
+    {
+      int r = rand() % 10;
+      hostRx += (char)((r < 3) ? 0xFF : (r < 5) ? 0x65 + rand() % 13 : rand() % 256);
+    }
+    events += run(0).size();
+  }
+  printf("nexinput: 20000 random streams ok (%ld bytes of events)\n", events);
+  return 0;
+}
@@ -0,0 +1,170 @@
+// Arduino parseParams(): which settings a request applies, heap use and time per request
+// params.inc is setParam() and parseParams() cut from Arduino/WebHandler.cpp, urldecode.inc is
+// WiFiManager::urldecode() as hostUrldecode() (see run.sh).  HVAC.cpp, eeMem.cpp and OutCurve.cpp are the real ones
+#include <new>
+#include <vector>
+#include "host.h"
+#include "HVAC.h"
+#include "eeMem.h"
+#include <EEPROM.h>
+
+static long allocs;
+
+void *operator new(size_t n)
+{
+  allocs++;
+  return malloc(n);
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+EEPROMClass EEPROM;
+HVAC hvac;
+eeMem eemem;
+
+void EEPROMClass::begin(int){}
+bool EEPROMClass::commit(){ return true; }
+uint8_t EEPROMClass::read(int){ return 0; }
+void EEPROMClass::write(int, uint8_t){}
+time_t now(){ return 1539000000; }
+int hour(){ return 12; }
+int minute(){ return 0; }
+int second(){ return 0; }
+int weekday(){ return 3; }
+
+// stand-ins for the library request and the parts of the other objects the params touch
+class AsyncWebParameter
+{
+public:
+  AsyncWebParameter(const char *pName, const char *pValue) : n(pName), v(pValue) {}
+  const String& name() const { return n; }
+  const String& value() const { return v; }
+private:
+  String n, v;
+};
+
+struct ParamsClient
+{
+  IPAddress remoteIP(){ return IPAddress(); }
+};
+
+class AsyncWebServerRequest
+{
+public:
+  std::vector<AsyncWebParameter> ps;
+  size_t params() const { return ps.size(); }
+  AsyncWebParameter* getParam(size_t i){ return &ps[i]; }
+  ParamsClient* client(){ return &cl; }
+private:
+  ParamsClient cl;
+};
+
+#include "urldecode.inc"
+
+struct ParamsWiFi
+{
+  auto urldecode(char *p) -> decltype(hostUrldecode(p)) { return hostUrldecode(p); }
+  void setPass(const char *){}
+} wifi;
+
+struct ParamsDisplay
+{
+  bool m_bUpdateFcst;
+  void init(){}
+} display;
+
+int nWrongPass;
+uint32_t lastIP;
+static int nWrong;
+void WsSend(char *, const char *){ nWrong++; } // only the "hack" log comes from parseParams
+void wrongKey(IPAddress, const char *){ nWrong++; }
+
+#include "params.inc"
+
+// plain settings that only write ee, with a value inside each one's limits
+static const struct { const char *pName; int val; } sets[] = {
+  {"fanpostdelay", 30}, {"cyclemin", 120}, {"cyclemax", 900}, {"idlemin", 300},
+  {"eheatthresh", 10}, {"overridetime", 600}, {"humidl", 400}, {"humidh", 600},
+  {"adj", -5}, {"fancycletime", 100}, {"awaytime", 120}, {"ppk", 150},
+  {"ccf", 1000}, {"cfm", 800}, {"fcrange", 20}, {"fcdisp", 30},
+};
+#define SETS (int)(sizeof(sets) / sizeof(sets[0]))
+
+static eeSet ee0;
+
+// n settings (names repeat with new values, so order matters), the key at keyAt
+static void request(AsyncWebServerRequest &req, int n, int keyAt, const char *pKey)
+{
+  req.ps.clear();
+  char buf[16];
+  for(int i = 0; i <= n; i++)
+  {
+    if(i == keyAt)
+      req.ps.push_back(AsyncWebParameter("key", pKey));
+    if(i == n)
+      break;
+    snprintf(buf, sizeof(buf), "%d", sets[i % SETS].val + i / SETS);
+    req.ps.push_back(AsyncWebParameter(sets[i % SETS].pName, buf));
+  }
+}
+
+// ee after setting the same values one at a time, in order
+static eeSet expected(AsyncWebServerRequest &req)
+{
+  ee = ee0;
+  for(size_t i = 0; i < req.params(); i++)
+    if(req.getParam(i)->name() != "key")
+      hvac.setVar(req.getParam(i)->name().c_str(), atoi(req.getParam(i)->value().c_str()));
+  eeSet e = ee;
+  ee = ee0;
+  return e;
+}
+
+static int check(const char *pWhat, int n, int keyAt, bool bGood)
+{
+  AsyncWebServerRequest req;
+  request(req, n, keyAt, bGood ? ee0.password : "wrong");
+  eeSet want = bGood ? expected(req) : ee0;
+  nWrong = 0;
+  parseParams(&req);
+  if(memcmp(&ee, &want, sizeof(ee)))
+    return hostFail(pWhat, bGood ? "settings not the same as setting each in order" : "settings applied with a wrong key");
+  if(nWrong != !bGood)
+    return hostFail(pWhat, "wrong key not logged once");
+  ee = ee0;
+  return 0;
+}
+
+// time and heap for one request, many times
+static void bench(const char *pWhat, int n, int keyAt, bool bWiFi = false)
+{
+  AsyncWebServerRequest req;
+  request(req, n, keyAt, ee0.password);
+  if(bWiFi) // values longer than String keeps inline
+  {
+    req.ps.insert(req.ps.begin(), AsyncWebParameter("pass", "correct%20horse%20battery%20staple"));
+    req.ps.insert(req.ps.begin(), AsyncWebParameter("ssid", "Upstairs%20Network%205GHz"));
+  }
+  const int reps = 200000;
+  allocs = 0;
+  double t = hostSecs();
+  for(int r = 0; r < reps; r++)
+    parseParams(&req);
+  t = hostSecs() - t;
+  printf("params: %s: %.2f us, %.1f heap allocations per request\n", pWhat, t * 1e6 / reps, (double)allocs / reps);
+  ee = ee0;
+}
+
+int main()
+{
+  ee0 = ee;
+  if(check("params key last", 6, 6, true) || check("params key first", 6, 0, true)
+      || check("params 30 before key", 30, 30, true) || check("params 30 before key, 5 after", 35, 30, true)
+      || check("params wrong key", 30, 30, false))
+    return 1;
+  printf("params: key first, last, after 30 and wrong, same settings as setting each in order\n");
+  bench("6 params, key last", 6, 6);
+  bench("30 params, key last", 30, 30);
+  bench("ssid, pass, 4 params, key last", 4, 4, true);
+  return 0;
+}
@@ -0,0 +1,138 @@
+#!/bin/bash
+# Builds and runs the host tests
+# Usage: run.sh [-b REV]   (-b also builds the benchmarks from git revision REV and compares)
+set -e
+cd "$(dirname "$0")"
+B=$PWD/build
+A=../../Arduino
+L=../../Libraries
+CXX="g++ -std=gnu++11 -w -Istub"
+SAN="-O1 -g -fsanitize=address,undefined -fno-omit-frame-pointer"
+BASE=
+[ "$1" = "-b" ] && BASE=$2
+mkdir -p $B
+
+# the Arduino and Libraries folders at REV, for the comparisons
+O=$B/base
+BA=$O/src/Arduino
+BL=$O/src/Libraries
+if [ "$BASE" ]; then
+  rm -rf $O
+  mkdir -p $O/src
+  git -C ../.. archive $BASE Arduino Libraries | tar -x -C $O/src
+fi
+
+echo "== median"
+$CXX -O2 -I$A median.cpp host.cpp -o $B/median
+$B/median
+if [ "$BASE" ]; then
+  echo "== median at $BASE"
+  $CXX -O2 -I$BA median.cpp host.cpp -o $O/median && $O/median || true
+fi
+
+echo "== filter"
+$CXX -O2 -I$A filter.cpp host.cpp -o $B/filter
+$B/filter
+
+echo "== nexcmd"
+$CXX -O2 -I$A nexcmd.cpp host.cpp $A/Nextion.cpp -o $B/nexcmd
+$B/nexcmd
+
+echo "== nexinput"
+$CXX $SAN -I$A nexinput.cpp host.cpp $A/Nextion.cpp -o $B/nexinput
+$B/nexinput
+
+# panel captures of each screen, measured by NexEmu (GRAPH_BUTTONS for the graph at every zoom)
+JS="-I$L/JsonParse -I$L/JsonTokenizer"
+g++ -O2 -w ../NexEmu/nexemu.cpp -o $B/nexemu
+caps="refreshAll forecast clock clocksec clockhour graph0 graph1 graph2 graph3"
+uart() # dir: one line per capture from NexEmu
+{
+  for c in $caps; do
+    printf "%-11s " $c
+    if [ -f $1/$c.bin ]; then $B/nexemu -o $1/$c.ppm $1/$c.bin | head -1; else echo "-"; fi
+  done
+}
+$CXX -O1 -DGRAPH_BUTTONS -I$A $JS nexcapture.cpp host.cpp $A/{display,Nextion,PolyLine,OutCurve,HVAC,eeMem}.cpp -o $B/nexcapture
+mkdir -p $B/cap
+$B/nexcapture $B/cap
+echo "== UART"
+uart $B/cap
+if [ "$BASE" ]; then
+  echo "== UART at $BASE"
+  mkdir -p $O/cap
+  BD="-I$BA -I$BL/JsonParse -I$BL/JsonTokenizer"
+  (grep -q 'updateClock(void)' $BA/display.h) && BD="$BD -DHOST_BASE_CLOCK"
+  (grep -q 'm_drawJob' $BA/display.h) || BD="$BD -DHOST_BASE_DRAW"
+  BDC=
+  for f in display Nextion PolyLine OutCurve HVAC eeMem; do [ -f $BA/$f.cpp ] && BDC="$BDC $BA/$f.cpp"; done
+  if $CXX -O1 -DGRAPH_BUTTONS $BD nexcapture.cpp host.cpp $BDC -o $O/nexcapture 2> $O/nexcapture.log; then
+    $O/nexcapture $O/cap || echo "nexcapture at $BASE stopped early"
+    uart $O/cap
+  else
+    echo "display code at $BASE does not build with nexcapture.cpp (see $O/nexcapture.log)"
+  fi
+fi
+
+echo "== xml"
+python3 dwml.py $B/dwml.xml
+$CXX -O2 -I$L/XMLReader xml.cpp host.cpp $L/XMLReader/XMLReader.cpp -o $B/xml
+$B/xml $B/dwml.xml
+if [ "$BASE" ]; then
+  echo "== xml at $BASE"
+  if $CXX -O2 -I$BL/XMLReader xml.cpp host.cpp $BL/XMLReader/XMLReader.cpp -o $O/xml; then
+    $O/xml $B/dwml.xml -b
+    $B/xml $B/dwml.xml -p > $O/xml.new
+    $O/xml $B/dwml.xml -p > $O/xml.old || true
+    cmp -s $O/xml.new $O/xml.old && echo "xml callbacks same" || echo "xml callbacks differ"
+  fi
+fi
+
+echo "== httplines"
+$CXX $SAN -I$A httplines.cpp host.cpp $A/HttpLines.cpp -o $B/httplines
+$B/httplines
+
+echo "== jsonparse"
+$CXX -O2 -I$L/JsonParse -I$L/JsonTokenizer jsonparse.cpp host.cpp $L/JsonParse/JsonParse.cpp $L/JsonTokenizer/JsonTokenizer.cpp -o $B/jsonparse
+$B/jsonparse
+if [ "$BASE" ]; then
+  echo "== jsonparse at $BASE"
+  BJS="-I$BL/JsonParse -I$BL/JsonTokenizer"
+  BJSC=$BL/JsonParse/JsonParse.cpp
+  [ -f $BL/JsonTokenizer/JsonTokenizer.cpp ] && BJSC="$BJSC $BL/JsonTokenizer/JsonTokenizer.cpp"
+  (grep -q 'bool process' $BL/JsonParse/JsonParse.h) || BJS="$BJS -DHOST_BASE"
+  if $CXX -O2 $BJS jsonparse.cpp host.cpp $BJSC -o $O/jsonparse; then
+    $O/jsonparse || true
+    $B/jsonparse -p > $O/json.new
+    $O/jsonparse -p > $O/json.old
+    cmp -s $O/json.new $O/json.old && echo "jsonparse callbacks same" || echo "jsonparse callbacks differ"
+  fi
+fi
+
+echo "== jsontok"
+$CXX $SAN -I$L/JsonParse -I$L/JsonTokenizer -I$L/JsonClient jsontok.cpp host.cpp $L/JsonClient/JsonClient.cpp $L/JsonTokenizer/JsonTokenizer.cpp -o $B/jsontok
+$B/jsontok
+
+echo "== wsheap"
+$CXX -O2 wsheap.cpp -o $B/wsheap
+$B/wsheap
+
+echo "== chart"
+sed -n '/^struct chartState$/,/^\/\/ Send the array formated chart data/p' ../../Remote/WebHandler.cpp | sed '$d' > $B/chart.inc
+$CXX $SAN -I$A -I$B chart.cpp host.cpp -o $B/chart
+$B/chart
+
+# setParam() and parseParams(), with WiFiManager::urldecode() as a free function
+params() # src dir, out dir
+{
+  awk '/^(static void setParam|void parseParams)\(/{p=1} p{print} p&&/^void parseParams/{q=1} q&&/^}/{exit}' $1/WebHandler.cpp > $2/params.inc
+  sed -n '/WiFiManager::urldecode/,/^}/p' $1/WiFiManager.cpp | sed 's/WiFiManager::urldecode/hostUrldecode/' > $2/urldecode.inc
+  $CXX -O2 -I$1 -I$2 params.cpp host.cpp $1/{HVAC,eeMem,OutCurve}.cpp -o $2/params
+}
+echo "== params"
+params $A $B
+$B/params
+if [ "$BASE" ]; then
+  echo "== params at $BASE"
+  params $BA $O && $O/params || true
+fi
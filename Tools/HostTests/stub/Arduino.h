@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+typedef uint8_t byte; typedef bool boolean;
+unsigned long millis(); void delayMicroseconds(unsigned); unsigned long micros(); void delay(unsigned long); void yield();
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+#define constrain(x,a,b) ((x)<(a)?(a):((x)>(b)?(b):(x)))
+class String { public: std::string s; String(){} void replace(const String&, const String&){} String(const char*p):s(p?p:""){} String(int v):s(std::to_string(v)){} String(unsigned v):s(std::to_string(v)){} String(long v):s(std::to_string(v)){} String(unsigned long v):s(std::to_string(v)){} String(double v, int d=2){char b[32];snprintf(b,32,"%.*f",d,v);s=b;}
+ const char*c_str()const{return s.c_str();} unsigned length()const{return s.size();} String&operator+=(const String&o){s+=o.s;return *this;} String&operator+=(const char*o){s+=o;return *this;} String&operator+=(char c){s+=c;return *this;} String&operator+=(int v){s+=std::to_string(v);return *this;}String&operator+=(unsigned v){s+=std::to_string(v);return *this;}String&operator+=(long v){s+=std::to_string(v);return *this;}String&operator+=(unsigned long v){s+=std::to_string(v);return *this;}String&operator+=(double v){s+=std::to_string(v);return *this;}
+ friend String operator+(const String&a,const String&b){String r=a;r.s+=b.s;return r;} friend String operator+(const String&a,const char*b){String r=a;r.s+=b;return r;} friend String operator+(const String&a,int b){String r=a;r.s+=std::to_string(b);return r;}
+ bool operator==(const char*o)const{return s==o;} bool operator!=(const char*o)const{return s!=o;} char charAt(unsigned i)const{return s[i];} long toInt()const{return atol(s.c_str());} void toCharArray(char*b,unsigned n)const{strncpy(b,s.c_str(),n);b[n-1]=0;} bool equalsIgnoreCase(const String&o)const{return strcasecmp(s.c_str(),o.s.c_str())==0;}};
+struct HardwareSerial { int available(); int read(); size_t write(uint8_t); size_t write(const uint8_t*,size_t); size_t print(const char*); size_t print(const String&); size_t println(const char* s=""); template<class T> size_t println(const T&); template<class T> size_t print(const T&); int availableForWrite(); void begin(long); size_t readBytesUntil(char,char*,size_t);};
+extern HardwareSerial Serial;
+#ifndef STUB_EXTRA
+#define STUB_EXTRA
+#include <stdio.h>
+#include <strings.h>
+inline char *itoa(int v, char *b, int r){ sprintf(b,"%d",v); return b;}
+long random(long,long); void randomSeed(unsigned long); int analogRead(int);
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define FALLING 2
+void pinMode(int,int); void attachInterrupt(int, void(*)(), int); void digitalWrite(int,int); int digitalRead(int);
+#define PROGMEM
+#define M_PI 3.14159265358979323846
+struct IPAddress { IPAddress(){} IPAddress(int,int,int,int){} IPAddress(uint32_t){} operator uint32_t() const {return 0;} String toString() const {return String();} bool fromString(const String&){return true;} };
+struct EspClass { uint32_t getFreeHeap(); }; extern EspClass ESP;
+#endif
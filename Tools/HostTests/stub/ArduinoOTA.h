@@ -0,0 +1,2 @@
+#pragma once
+struct OTAClass{void begin(); void handle();}; extern OTAClass ArduinoOTA;
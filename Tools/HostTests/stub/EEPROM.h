@@ -0,0 +1,3 @@
+#pragma once
+#include "Arduino.h"
+struct EEPROMClass{ void begin(int); uint8_t read(int); void write(int,uint8_t); bool commit();}; extern EEPROMClass EEPROM;
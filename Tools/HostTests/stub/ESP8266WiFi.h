@@ -0,0 +1,5 @@
+#pragma once
+#include "Arduino.h"
+struct WiFiClass { int32_t RSSI(); int32_t RSSI(int); int encryptionType(int); String SSID(int); IPAddress localIP(); void hostname(const char*); int scanNetworks(); void mode(int); void begin(const char*, const char*); void softAP(const char*); int status(); IPAddress softAPIP(); void disconnect(); };
+enum { WIFI_STA, WIFI_AP, WL_CONNECTED };
+extern WiFiClass WiFi;
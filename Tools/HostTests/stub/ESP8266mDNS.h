@@ -0,0 +1,3 @@
+#pragma once
+#include "ESP8266WiFi.h"
+struct MDNSResponder{bool begin(const char*, IPAddress); bool begin(const char*); void update(); void addService(const char*,const char*,int);}; extern MDNSResponder MDNS;
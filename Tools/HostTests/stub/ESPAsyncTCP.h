@@ -0,0 +1,8 @@
+#pragma once
+#include "Arduino.h"
+#include <functional>
+class AsyncClient { public: typedef std::function<void(void*,AsyncClient*)> cb; 
+ void onConnect(std::function<void(void*,AsyncClient*)>, void* a=0); void onDisconnect(std::function<void(void*,AsyncClient*)>, void* a=0);
+ void onTimeout(std::function<void(void*,AsyncClient*,uint32_t)>, void* a=0); void onData(std::function<void(void*,AsyncClient*,void*,size_t)>, void* a=0);
+ void onError(std::function<void(void*,AsyncClient*,int8_t)>, void* a=0);
+ bool connect(const char*, uint16_t); bool connect(IPAddress, uint16_t); bool connected(); void stop(); void close(bool now=false); size_t add(const char*, size_t); bool send(); void setRxTimeout(uint32_t); IPAddress remoteIP(); size_t space(); };
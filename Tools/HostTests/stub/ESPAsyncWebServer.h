@@ -0,0 +1,24 @@
+#pragma once
+#include "ESPAsyncTCP.h"
+#include <functional>
+enum { HTTP_GET=1, HTTP_POST=2 };
+class AsyncWebHeader { public: const String& name() const; const String& value() const; };
+class AsyncWebParameter { public: const String& name() const; const String& value() const; bool isPost() const; };
+class AsyncWebServerResponse { public: void addHeader(const String&, const String&); };
+class AsyncResponseStream : public AsyncWebServerResponse { public: size_t print(const char*); size_t print(const String&); size_t write(const uint8_t*, size_t); };
+typedef std::function<size_t(uint8_t*, size_t, size_t)> AwsResponseFiller;
+class AsyncWebServerRequest { public: size_t params() const; AsyncWebParameter* getParam(size_t); AsyncWebParameter* getParam(const String&, bool post=false); bool hasParam(const String&, bool post=false); AsyncClient* client(); void send(int, const char*, const String&); void send(int); void send(AsyncResponseStream*); void send(AsyncWebServerResponse*); template<class F> void send(F&, const String&); AsyncResponseStream* beginResponseStream(const String&); void send_P(int, const char*, const char*); AsyncWebServerResponse* beginChunkedResponse(const String&, AwsResponseFiller); AsyncWebServerResponse* beginResponse(int, const String&, const String&); bool hasHeader(const String&); AsyncWebHeader* getHeader(const String&); void* _tempObject; int method(); };
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, uint8_t*, size_t, size_t, size_t)> ArBodyHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, const String&, size_t, uint8_t*, size_t, bool)> ArUploadHandlerFunction;
+class AsyncWebSocketMessageBuffer { public: uint8_t *get(); size_t length(); bool reserve(size_t); void lock(); void unlock(); };
+class AsyncWebSocketClient { public: uint32_t id(); IPAddress remoteIP(); void text(const char*); void text(const String&); void text(AsyncWebSocketMessageBuffer*); void ping(); bool queueIsFull(); };
+enum AwsEventType { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA };
+enum { WS_TEXT=1 };
+struct AwsFrameInfo { uint8_t final; uint64_t index; uint64_t len; uint8_t opcode; };
+class AsyncWebSocket; typedef std::function<void(AsyncWebSocket*, AsyncWebSocketClient*, AwsEventType, void*, uint8_t*, size_t)> AwsEventHandler;
+class AsyncWebHandler {};
+class AsyncWebSocket : public AsyncWebHandler { public: AsyncWebSocket(const char*); void onEvent(AwsEventHandler); void textAll(const char*); void textAll(const String&); void textAll(AsyncWebSocketMessageBuffer*); void text(uint32_t, const char*); void text(uint32_t, const String&); void text(uint32_t, AsyncWebSocketMessageBuffer*); AsyncWebSocketMessageBuffer* makeBuffer(size_t); bool availableForWriteAll(); size_t count() const; };
+class AsyncEventSourceClient {};
+class AsyncEventSource : public AsyncWebHandler { public: AsyncEventSource(const char*); void onConnect(std::function<void(AsyncEventSourceClient*)>); void send(const char*, const char* e=0, uint32_t id=0, uint32_t r=0); size_t count() const; size_t avgPacketsWaiting() const; };
+class AsyncWebServer { public: AsyncWebServer(int); void addHandler(AsyncWebHandler*); void on(const char*, int, ArRequestHandlerFunction); void on(const char*, int, ArRequestHandlerFunction, ArUploadHandlerFunction, ArBodyHandlerFunction); void onNotFound(ArRequestHandlerFunction); void onFileUpload(ArUploadHandlerFunction); void onRequestBody(ArBodyHandlerFunction); void begin(); };
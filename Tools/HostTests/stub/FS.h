@@ -0,0 +1,4 @@
+#pragma once
+#include "Arduino.h"
+class File { public: size_t write(const uint8_t*, size_t); size_t read(uint8_t*, size_t); size_t size(); void close(); operator bool() const; };
+struct FSClass { bool begin(); File open(const char*, const char*); bool exists(const char*); bool remove(const char*); }; extern FSClass SPIFFS;
@@ -0,0 +1,3 @@
+#pragma once
+#include "ESPAsyncWebServer.h"
+struct SPIFFSEditor : AsyncWebHandler { SPIFFSEditor(const char*, const char*); };
@@ -0,0 +1,7 @@
+#pragma once
+#include "Arduino.h"
+#include <time.h>
+struct tmElements_t { uint8_t Second, Minute, Hour, Wday, Day, Month, Year; };
+#define CalendarYrToTm(Y) ((Y) - 1970)
+time_t now(); int hour(); int minute(); int second(); int day(); int weekday(); int month(); int year(); int hourFormat12(); bool isPM(); time_t makeTime(const tmElements_t&); void breakTime(time_t, tmElements_t&);
+int hour(time_t); int minute(time_t); int weekday(time_t);
@@ -0,0 +1,3 @@
+#pragma once
+#include "Arduino.h"
+struct UdpTime{ void start(); bool check(int); int getDST(); };
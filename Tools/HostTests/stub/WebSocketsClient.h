@@ -0,0 +1,4 @@
+#pragma once
+#include <Arduino.h>
+enum WStype_t { WStype_ERROR, WStype_DISCONNECTED, WStype_CONNECTED, WStype_TEXT, WStype_BIN };
+struct WebSocketsClient { void begin(const char*, int, const char* = "/"); void begin(IPAddress, int, const char* = "/"); void onEvent(void(*)(WStype_t, uint8_t*, size_t)); void loop(); bool sendTXT(const char*); bool sendTXT(String&); void disconnect(); };
@@ -0,0 +1,4 @@
+#pragma once
+#include "Arduino.h"
+struct TwoWire{ void begin(int,int); void setClock(long); void beginTransmission(int); size_t write(uint8_t); uint8_t endTransmission(); uint8_t requestFrom(int,int); int available(); int read(); };
+extern TwoWire Wire;
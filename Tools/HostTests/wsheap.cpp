@@ -0,0 +1,73 @@
+// Heap held by one WebSocket broadcast to N clients, before and after the shared buffer
+//
+// A model, not a measurement: it replays the allocations ESPAsyncWebServer makes for
+// ws.textAll(String) and ws.textAll(makeBuffer()) with the ESP8266 object sizes, on
+// umm_malloc's 8 byte blocks with a 4 byte header.  Everything stays queued until
+// the clients are sent to, so the peak is the sum.  SSE is not in it: WsSend() hands the
+// same bytes to events.send(), but the library still keeps a copy per SSE client.
+#include "host.h"
+
+#define MSG_SIZE    32 // AsyncWebSocketBasicMessage: vtable, opcode/mask/status, sent/ack/acked, data, len
+#define MULTI_SIZE  36 // AsyncWebSocketMultiMessage: the same with a buffer pointer instead of its own copy
+#define BUF_SIZE    16 // AsyncWebSocketMessageBuffer: data, len, lock, count
+#define NODE_SIZE    8 // LinkedList node in the client's message queue
+
+static long heap, peak;
+
+static void alloc(int n)
+{
+  heap += ((n + 4 + 7) / 8) * 8;
+  if(heap > peak) peak = heap;
+}
+
+static void release(int n)
+{
+  heap -= ((n + 4 + 7) / 8) * 8;
+}
+
+// WsSend(): String s = type; s += ";"; s += txt; ws.textAll(s);
+static long before(int len, int clients)
+{
+  heap = peak = 0;
+  int typeLen = 5;
+  alloc(typeLen + 1);             // String s = type
+  alloc(typeLen + 2);             // += ";" (realloc moves it)
+  release(typeLen + 1);
+  alloc(len + 1);                 // += txt
+  release(typeLen + 2);
+  for(int i = 0; i < clients; i++) // textAll(): a copy per client
+  {
+    alloc(MSG_SIZE);
+    alloc(len + 1);
+    alloc(NODE_SIZE);
+  }
+  return peak;
+}
+
+// wsTextAll(): one buffer, a small message per client pointing at it
+static long after(int len, int clients)
+{
+  heap = peak = 0;
+  alloc(BUF_SIZE);                // ws.makeBuffer(len)
+  alloc(len + 1);
+  for(int i = 0; i < clients; i++) // textAll(buffer)
+  {
+    alloc(MULTI_SIZE);
+    alloc(NODE_SIZE);
+  }
+  return peak;
+}
+
+int main()
+{
+  const int len = 330; // "state;{...}" as sent each second
+  printf("wsheap: modelled peak heap for one %d byte WebSocket broadcast\n", len);
+  printf("  N      ");
+  for(int n = 1; n <= 8; n *= 2) printf("%6d", n);
+  printf("\n  before ");
+  for(int n = 1; n <= 8; n *= 2) printf("%6ld", before(len, n));
+  printf("\n  after  ");
+  for(int n = 1; n <= 8; n *= 2) printf("%6ld", after(len, n));
+  printf(" bytes (modelled)\n");
+  return 0;
+}
@@ -0,0 +1,151 @@
+// XMLReader: callbacks at any chunking, and scan speed on a DWML document (see dwml.py)
+// Usage: xml dwml.xml [-p|-b]
+//   -p prints the callbacks of the forecast list, for diffing two builds
+//   -b only times it (readers before the resumable one fail the split test)
+#include <vector>
+#include "host.h"
+#define private public // to feed _onData() directly
+#include "XMLReader.h"
+#undef private
+
+static std::string out;
+static int state;
+static bool bKeep = true; // off while timing
+
+static void cb(int item, int idx, char *p, char *pTag)
+{
+  if(item == -1)
+  {
+    state = idx;
+    return;
+  }
+  if(!bKeep)
+    return;
+  char buf[200];
+  snprintf(buf, sizeof(buf), "%d %d [%s]\n", item, idx, p);
+  out += buf;
+}
+
+// the forecast part of the firmware list, in document order so any version reads it
+static const XML_tag_t Xfc[] =
+{
+  {"time-layout", "time-coordinate", "local", 64 * 2 * 3},
+  {"temperature", "type", "hourly", 64 * 3},
+  {NULL}
+};
+static const XML_tag_t Xall[] = // never completes, scans the whole document
+{
+  {"nothere", NULL, NULL, 1},
+  {NULL}
+};
+
+// the firmware list (WebHandler.cpp)
+static const XML_tag_t Xfw[] =
+{
+  {"creation-date", NULL, NULL, 1},
+  {"time-layout", "time-coordinate", "local", 64 * 2 * 3},
+  {"temperature", "type", "hourly", 64 * 3},
+  {"temperature", "type", "dew point", 64 * 3},
+  {NULL}
+};
+static const XML_tag_t Xorder[] = // humidity comes later in the document than listed
+{
+  {"humidity", "type", "relative", 64 * 3},
+  {"temperature", "type", "dew point", 64 * 3},
+  {"hourly-qpf", "type", "floating", 64 * 3},
+  {NULL}
+};
+
+static XMLReader xml(cb, Xfc);
+static XMLReader xmlFw(cb, Xfw);
+static XMLReader xmlOrder(cb, Xorder);
+static XMLReader xmlAll(cb, Xall);
+
+// feed the document chunk bytes at a time (0 = random 1-99), stop when completed
+static size_t feed(XMLReader &r, const std::vector<char> &doc, size_t chunk)
+{
+  std::vector<char> c;
+  size_t o = 0;
+  out.clear();
+  state = 0;
+  r.begin("x", 80, "/");
+  while(o < doc.size() && state == 0)
+  {
+    size_t l = chunk ? chunk : 1 + rand() % 99;
+    if(l > doc.size() - o) l = doc.size() - o;
+    c.assign(doc.begin() + o, doc.begin() + o + l); // data arrives in a TCP buffer
+    r._onData(NULL, &c[0], l);
+    o += l;
+  }
+  return o;
+}
+
+int main(int argc, char **argv)
+{
+  if(argc < 2)
+  {
+    printf("usage: xml dwml.xml [-p|-b]\n");
+    return 1;
+  }
+  FILE *fp = fopen(argv[1], "rb");
+  if(fp == NULL)
+  {
+    perror(argv[1]);
+    return 1;
+  }
+  std::vector<char> doc(1 << 20);
+  doc.resize(fread(&doc[0], 1, doc.size(), fp));
+  fclose(fp);
+
+  feed(xml, doc, 1460);
+  std::string ref = out;
+  if(argc > 2 && !strcmp(argv[2], "-p"))
+  {
+    printf("%sstate %d\n", ref.c_str(), state);
+    return 0;
+  }
+  int rc = 0;
+  srand(3);
+  for(int i = 0; i < 200 && rc == 0 && argc == 2; i++)
+  {
+    feed(xml, doc, (i < 100) ? i + 1 : 0);
+    if(out != ref)
+      rc = hostFail("xml", "callbacks depend on how the document is split");
+  }
+  if(argc == 2 && rc == 0)
+    printf("xml: %zu bytes of callbacks, same at 200 chunkings\n", ref.size());
+  if(argc == 2)
+  {
+    feed(xmlFw, doc, 1460);
+    int items[16] = {0};
+    for(size_t i = 0; i < out.size(); i = out.find('\n', i) + 1)
+      items[atoi(&out[i]) & 15]++;
+    if(state != XML_COMPLETED || items[2] < 168 || items[3] < 168)
+      rc = hostFail("xml", "the firmware list didn't read every series");
+    else
+      printf("xml: firmware list completed, %d/%d temperature/dew values\n", items[2], items[3]);
+
+    feed(xmlOrder, doc, 1460);
+    memset(items, 0, sizeof(items));
+    for(size_t i = 0; i < out.size(); i = out.find('\n', i) + 1)
+      items[atoi(&out[i]) & 15]++;
+    if(state != XML_COMPLETED || items[0] < 168 || items[1] < 168 || items[2] < 168)
+      rc = hostFail("xml", "tags listed out of document order weren't all read");
+    else
+      printf("xml: out of order list completed, %d/%d/%d humidity/dew/qpf values\n", items[0], items[1], items[2]);
+  }
+
+  bKeep = false;
+  XMLReader *r[3] = {&xml, &xmlAll, &xmlFw};
+  const char *name[3] = {"up to the forecast tags", "whole document", "firmware list"};
+  for(int k = 0; k < ((argc == 2) ? 3 : 2); k++)
+  {
+    size_t bytes = 0;
+    int reps = 0;
+    double t = hostSecs();
+    for(; hostSecs() - t < 0.5; reps++)
+      bytes += feed(*r[k], doc, 1460);
+    printf("  %-24s %6.0f MB/s (%zu bytes a pass)\n", name[k], bytes / (hostSecs() - t) / 1e6, bytes / reps);
+  }
+  return rc;
+}
@@ -0,0 +1,263 @@
+// Nextion command stream emulator for the host
+//
+// Reads the raw bytes sent to the panel (commands ending in FF FF FF), draws the
+// line/fill/cls/xstr graphics into a 320x240 framebuffer and writes it as a PPM.
+// Component properties (.txt .pic .pco .val .bco vis) are tracked but not drawn, since
+// the layout lives in the HMI file.  Also reports bytes, commands and the time the
+// stream takes at 115200 baud, plus the panel pauses the Nextion class adds.
+//
+// Build: g++ -O2 -o nexemu nexemu.cpp
+// Usage: nexemu [-o out.ppm] [-p] capture.bin   (- for stdin, -p prints the properties)
+//
+// Capture by tapping the ESP TX line with a USB serial adapter:
+//   stty -F /dev/ttyUSB0 115200 raw; cat /dev/ttyUSB0 > capture.bin
+//
+// Tools/HostTests/nexcapture writes captures of each screen from the display code built
+// on the host, and Tools/HostTests/run.sh -b REV prints them before and after a change.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+
+#define W 320
+#define H 240
+#define BAUD 115200
+
+static uint16_t fb[W*H];
+
+struct cmdStat
+{
+  uint32_t cnt;
+  uint32_t bytes;
+};
+
+static std::map<std::string, cmdStat> stats;
+static std::map<std::string, std::string> props; // "t1.txt" = "value"
+static uint32_t pauseMs; // same pauses as Nextion::queueCmd()
+static int unknown;
+
+static void pixel(int x, int y, uint16_t c)
+{
+  if(x >= 0 && x < W && y >= 0 && y < H)
+    fb[y*W + x] = c;
+}
+
+static void fill(int x, int y, int w, int h, uint16_t c)
+{
+  for(int j = y; j < y + h; j++)
+    for(int i = x; i < x + w; i++)
+      pixel(i, j, c);
+}
+
+static void line(int x0, int y0, int x1, int y1, uint16_t c)
+{
+  int dx = abs(x1 - x0), sx = (x0 < x1) ? 1 : -1;
+  int dy = -abs(y1 - y0), sy = (y0 < y1) ? 1 : -1;
+  int err = dx + dy;
+
+  for(;;)
+  {
+    pixel(x0, y0, c);
+    if(x0 == x1 && y0 == y1)
+      break;
+    int e2 = 2 * err;
+    if(e2 >= dy) { err += dy; x0 += sx; }
+    if(e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+// text as a block per character (no font), 9 pixels per character like Nextion::text()
+static void xstr(int x, int y, int w, int h, uint16_t pco, uint16_t bco, int xcen, int sta, const char *s)
+{
+  if(sta == 1) // solid background
+    fill(x, y, w, h, bco);
+  int tw = strlen(s) * 9;
+  int tx = x;
+  if(xcen == 1) tx = x + (w - tw) / 2;
+  else if(xcen == 2) tx = x + w - tw;
+  for(; *s; s++, tx += 9)
+    if(*s != ' ')
+      fill(tx + 1, y + 3, 7, h - 6, pco);
+}
+
+// split "a,b,c" into ints, returns count
+static int nums(const char *p, int *v, int max)
+{
+  int n = 0;
+  while(*p && n < max)
+  {
+    v[n++] = atoi(p);
+    while(*p && *p != ',') p++;
+    if(*p == ',') p++;
+    if(*p == '"') break;
+  }
+  return n;
+}
+
+static void command(const std::string &cmd, uint32_t bytes)
+{
+  const char *p = cmd.c_str();
+  std::string name;
+  int v[12];
+
+  const char *sp = strchr(p, ' ');
+  const char *eq = strchr(p, '=');
+  if(sp && (!eq || sp < eq))
+    name = std::string(p, sp - p);
+  else if(eq && strchr(p, '.') && strchr(p, '.') < eq)
+    name = std::string(strchr(p, '.'), eq - strchr(p, '.')); // ".txt"
+  else if(eq)
+    name = std::string(p, eq - p); // dim=
+  else
+    name = p;
+
+  stats[name].cnt++;
+  stats[name].bytes += bytes;
+
+  if(name == "line" && nums(sp + 1, v, 5) == 5)
+  {
+    line(v[0], v[1], v[2], v[3], v[4]);
+    pauseMs += 1;
+  }
+  else if(name == "fill" && nums(sp + 1, v, 5) == 5)
+  {
+    fill(v[0], v[1], v[2], v[3], v[4]);
+    pauseMs += 1;
+  }
+  else if(name == "crop" && nums(sp + 1, v, 5) == 5)
+  {
+    fill(v[0], v[1], v[2], v[3], 0); // the picture isn't known, restore to black
+    pauseMs += 1;
+  }
+  else if(name == "cls")
+  {
+    fill(0, 0, W, H, atoi(sp + 1));
+    pauseMs += 10;
+  }
+  else if(name == "xstr" && nums(sp + 1, v, 10) == 10)
+  {
+    const char *q = strchr(p, '"');
+    std::string s = q ? std::string(q + 1) : "";
+    if(s.size() && s[s.size()-1] == '"')
+      s.erase(s.size() - 1);
+    xstr(v[0], v[1], v[2], v[3], v[5], v[6], v[7], v[9], s.c_str());
+    pauseMs += 2;
+  }
+  else if(name == "page")
+  {
+    memset(fb, 0, sizeof(fb)); // the page image isn't known, start black
+    props.clear();
+    pauseMs += 25;
+  }
+  else if(name == "ref")
+    pauseMs += 8; // redraws a component, which isn't known here
+  else if(name == "vis")
+  {
+    const char *c = strchr(sp + 1, ',');
+    if(c)
+      props[std::string(sp + 1, c - sp - 1) + ".vis"] = c + 1;
+  }
+  else if(name[0] == '.') // t1.txt="abc"
+  {
+    std::string val = eq + 1;
+    if(val.size() >= 2 && val[0] == '"')
+      val = val.substr(1, val.size() - 2);
+    props[std::string(p, eq - p)] = val;
+  }
+  else if(name != "dim" && name != "rest" && name != "ref_star" && name != "ref_stop" && name != "add")
+    unknown++;
+}
+
+int main(int argc, char **argv)
+{
+  const char *pOut = "nexemu.ppm";
+  const char *pIn = NULL;
+  bool bProps = false;
+
+  for(int i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "-o") && i + 1 < argc)
+      pOut = argv[++i];
+    else if(!strcmp(argv[i], "-p"))
+      bProps = true;
+    else
+      pIn = argv[i];
+  }
+  if(pIn == NULL)
+  {
+    fprintf(stderr, "usage: nexemu [-o out.ppm] [-p] capture.bin\n");
+    return 1;
+  }
+
+  FILE *fp = strcmp(pIn, "-") ? fopen(pIn, "rb") : stdin;
+  if(fp == NULL)
+  {
+    perror(pIn);
+    return 1;
+  }
+
+  std::string cmd;
+  uint32_t total = 0, cmds = 0;
+  int ff = 0, c;
+
+  while((c = fgetc(fp)) != EOF)
+  {
+    total++;
+    if(c == 0xFF)
+    {
+      if(++ff == 3)
+      {
+        if(cmd.size())
+        {
+          command(cmd, cmd.size() + 3);
+          cmds++;
+        }
+        cmd.clear();
+        ff = 0;
+      }
+      continue;
+    }
+    while(ff) // 0xFF that wasn't a terminator
+    {
+      cmd += (char)0xFF;
+      ff--;
+    }
+    cmd += (char)c;
+  }
+  if(fp != stdin)
+    fclose(fp);
+
+  double txMs = total * 10.0 * 1000 / BAUD; // 8N1
+  printf("bytes %u  commands %u  transfer %.1f ms  with panel pauses %.1f ms\n", total, cmds, txMs, txMs + pauseMs);
+  for(std::map<std::string, cmdStat>::iterator it = stats.begin(); it != stats.end(); ++it)
+    printf("  %-10s %6u cmds %7u bytes %8.1f ms\n", it->first.c_str(), it->second.cnt, it->second.bytes, it->second.bytes * 10.0 * 1000 / BAUD);
+  if(unknown)
+    printf("  %d unknown commands\n", unknown);
+  if(cmd.size())
+    printf("  %u bytes without a terminator at the end\n", (unsigned)cmd.size());
+
+  if(bProps)
+    for(std::map<std::string, std::string>::iterator it = props.begin(); it != props.end(); ++it)
+      printf("%s = %s\n", it->first.c_str(), it->second.c_str());
+
+  fp = fopen(pOut, "wb");
+  if(fp == NULL)
+  {
+    perror(pOut);
+    return 1;
+  }
+  fprintf(fp, "P6\n%d %d\n255\n", W, H);
+  for(int i = 0; i < W*H; i++) // 5-6-5 to 8 bits
+  {
+    uint16_t v = fb[i];
+    fputc(((v >> 11) & 0x1F) * 255 / 31, fp);
+    fputc(((v >> 5) & 0x3F) * 255 / 63, fp);
+    fputc((v & 0x1F) * 255 / 31, fp);
+  }
+  fclose(fp);
+  return 0;
+}